@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+# Compares two summaries printed by run.sh (baseline first) and fails on a regression:
+# NET and RAM are deterministic and may not grow at all, CPU may grow by up to
+# the threshold (percent, default 20) to absorb timing noise.
+#
+# usage: compare.sh <baseline summary> <current summary> [cpu threshold %]
+set -euo pipefail
+
+BASELINE=${1:?usage: compare.sh <baseline summary> <current summary> [cpu threshold %]}
+CURRENT=${2:?usage: compare.sh <baseline summary> <current summary> [cpu threshold %]}
+THRESHOLD=${3:-20}
+
+awk -F, -v threshold="$THRESHOLD" '
+   FNR == 1 { next }
+   NR == FNR { cpu[$1 "," $2] = $4; net[$1 "," $2] = $5; ram[$1 "," $2] = $6; next }
+   {
+      key = $1 "," $2
+      if (!(key in cpu)) { printf "%-32s new\n", key; next }
+      status = "ok"
+      if ($5 > net[key] || $6 > ram[key] || $4 > cpu[key] * (1 + threshold / 100)) {
+         status = "REGRESSION"
+         failed = 1
+      }
+      printf "%-32s cpu %8.1f -> %8.1f  net %7.1f -> %7.1f  ram %8.1f -> %8.1f  %s\n",
+             key, cpu[key], $4, net[key], $5, ram[key], $6, status
+   }
+   END { exit failed }
+' "$BASELINE" "$CURRENT"
@@ -0,0 +1,61 @@
+# Helpers shared by run.sh and the workloads (sourced, not executed).
+
+CLEOS=${CLEOS:-cleos}
+NODEOS=${NODEOS:-nodeos}
+KEOSD=${KEOSD:-keosd}
+BENCH_PORT=${BENCH_PORT:-18888}
+
+# Development key of the local test chain, also used for every bench account
+DEV_PUB=EOS6MRyAjQq8ud7hVNYcfnVPJqcVpscN5So8BhtHuGYqET5GDW5CV
+DEV_KEY=5KQwrPbwdL6PhXujxW37FSSQZ1JiwsST4cqQzDeyXtP79zkvFD3
+
+cleos_() {
+   "$CLEOS" -u "http://127.0.0.1:$BENCH_PORT" --wallet-url "unix://$BENCH_TMP/keosd.sock" "$@"
+}
+
+# user <index>: name of the index-th bench user account (bench.aaaaa, bench.aaaab, ...)
+user() {
+   local chars=abcdefghijklmnopqrstuvwxyz12345 n=$1 suffix=""
+   for _ in 1 2 3 4 5; do
+      suffix=${chars:$(( n % 31 )):1}$suffix
+      n=$(( n / 31 ))
+   done
+   echo "bench.$suffix"
+}
+
+# push <workload> <contract account> <action> <json data> <actor>
+# Pushes one action and appends "workload,action,cpu_us,net_bytes,ram_bytes" to $RESULTS.
+# ram_bytes is the sum of the RAM deltas of every account, inline actions included.
+# Identical pushes within the expiration window are rejected as duplicates,
+# so workloads vary the data (a memo, a counter) between repeated actions.
+push() {
+   local workload=$1 contract=$2 action=$3 data=$4 actor=$5
+   cleos_ push action "$contract" "$action" "$data" -p "$actor@active" --json |
+      jq -r --arg w "$workload" --arg a "$action" '
+         [ $w, $a,
+           .processed.receipt.cpu_usage_us,
+           .processed.receipt.net_usage_words * 8,
+           ([ .processed.action_traces[].account_ram_deltas[]?.delta ] | add // 0)
+         ] | map(tostring) | join(",")' >>"$RESULTS"
+}
+
+# json_list <count> <printf format> [first]: JSON array of count items,
+# the format gets the item number, counted from first (default 0)
+json_list() {
+   local count=$1 format=$2 first=${3:-0} i sep="" out="["
+   for (( i = first; i < first + count; i++ )); do
+      out+=$sep$(printf "$format" "$i")
+      sep=,
+   done
+   echo "$out]"
+}
+
+# user_list <first> <count>: JSON array of the names of count users from index first
+user_list() {
+   local i sep="" out="["
+   for (( i = $1; i < $1 + $2; i++ )); do
+      out+="$sep\"$(user "$i")\""
+      sep=,
+   done
+   echo "$out]"
+}
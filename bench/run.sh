@@ -0,0 +1,85 @@
+#!/usr/bin/env bash
+# Replays scripted workloads against the contracts on a throwaway local chain and
+# records the billed CPU, NET and RAM of every action pushed, then prints the mean
+# per (workload, action). See README.md.
+#
+# usage: run.sh [--quick] <contracts build dir> [results.csv]
+#   --quick  divide the workload sizes by 100 (smoke run, used by ctest)
+set -euo pipefail
+
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+source "$BENCH_DIR/lib.sh"
+
+SCALE=1
+if [[ "${1:-}" == "--quick" ]]; then
+   SCALE=100
+   shift
+fi
+BUILD_DIR=$(cd "${1:?usage: run.sh [--quick] <contracts build dir> [results.csv]}" && pwd)
+RESULTS=$(realpath -m "${2:-bench_output.csv}")
+
+BENCH_TMP=$(mktemp -d)
+cleanup() {
+   kill "${NODEOS_PID:-}" "${KEOSD_PID:-}" 2>/dev/null || true
+   wait 2>/dev/null || true
+   rm -rf "$BENCH_TMP"
+}
+trap cleanup EXIT
+
+# Single producer chain without a system contract: nothing limits resources,
+# but every receipt still carries the billed CPU and NET.
+"$NODEOS" -e -p eosio \
+   --data-dir "$BENCH_TMP/data" --config-dir "$BENCH_TMP/config" \
+   --plugin eosio::producer_plugin --plugin eosio::chain_api_plugin --plugin eosio::http_plugin \
+   --http-server-address "127.0.0.1:$BENCH_PORT" \
+   --signature-provider "$DEV_PUB=KEY:$DEV_KEY" \
+   --max-transaction-time 1000 --contracts-console \
+   >"$BENCH_TMP/nodeos.log" 2>&1 &
+NODEOS_PID=$!
+
+"$KEOSD" --wallet-dir "$BENCH_TMP/wallet" --unix-socket-path "$BENCH_TMP/keosd.sock" \
+   --http-server-address "" >"$BENCH_TMP/keosd.log" 2>&1 &
+KEOSD_PID=$!
+
+for _ in $(seq 1 30); do
+   cleos_ get info >/dev/null 2>&1 && break
+   sleep 1
+done
+cleos_ get info >/dev/null
+
+cleos_ wallet create -n bench -f "$BENCH_TMP/wallet.pw" >/dev/null
+cleos_ wallet import -n bench --private-key "$DEV_KEY" >/dev/null
+
+# Contract accounts, named after their contract; msg is deployed as messenger
+CONTRACTS="stablecoin:stablecoin pollgf:pollgf messenger:msg gfatm:gfatm database:database mycontract:mycontract"
+for entry in $CONTRACTS; do
+   account=${entry%%:*}
+   output=${entry##*:}
+   cleos_ create account eosio "$account" "$DEV_PUB" "$DEV_PUB" >/dev/null
+   cleos_ set contract "$account" "$BUILD_DIR" "$output.wasm" "$output.abi" >/dev/null
+done
+cleos_ set account permission stablecoin active --add-code >/dev/null
+
+USERS=$(( 1000 / SCALE ))
+for (( i = 0; i < USERS; i++ )); do
+   cleos_ create account eosio "$(user "$i")" "$DEV_PUB" "$DEV_PUB" >/dev/null
+done
+
+: >"$RESULTS"
+# stablecoin goes first: it funds the users for gfatm
+for name in stablecoin gfatm pollgf msg database mycontract; do
+   source "$BENCH_DIR/workloads/$name.sh"
+   echo "running $name" >&2
+   "workload_$name"
+done
+
+# Mean per (workload, action)
+echo "workload,action,count,cpu_us,net_bytes,ram_bytes"
+awk -F, '{
+   key = $1 "," $2
+   count[key]++; cpu[key] += $3; net[key] += $4; ram[key] += $5
+} END {
+   for (key in count)
+      printf "%s,%d,%.1f,%.1f,%.1f\n", key, count[key],
+             cpu[key] / count[key], net[key] / count[key], ram[key] / count[key]
+}' "$RESULTS" | sort
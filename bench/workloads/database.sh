@@ -0,0 +1,19 @@
+# database: posts created, updated (title only, then content) and erased by each user.
+workload_database() {
+   local posts=$(( 1000 / SCALE )) i poster id
+
+   for (( i = 0; i < posts; i++ )); do
+      poster=$(user $(( i % USERS )))
+      push database database create "[\"$poster\",\"title $i\",\"content of post $i\"]" "$poster"
+   done
+   for (( i = 0; i < posts; i++ )); do
+      poster=$(user $(( i % USERS )))
+      id=$(( i / USERS ))
+      push database database update "[\"$poster\",$id,\"new title $i\",null]" "$poster"
+      push database database update "[\"$poster\",$id,null,\"new content $i\"]" "$poster"
+   done
+   for (( i = 0; i < posts; i++ )); do
+      poster=$(user $(( i % USERS )))
+      push database database erase "[\"$poster\",$(( i / USERS ))]" "$poster"
+   done
+}
@@ -0,0 +1,20 @@
+# gfatm: transfers of the limited token to the ATM in rolling window mode, then
+# calendar day mode, and a prune sweep. Runs after stablecoin, which funded the users.
+workload_gfatm() {
+   local transfers=$(( 1000 / SCALE )) i from
+   local limits='[{"token":{"sym":"4,GFT","contract":"stablecoin"},"daily_limit":1000000000}]'
+
+   push gfatm gfatm config "[0,$limits,true]" gfatm
+   for (( i = 0; i < transfers; i++ )); do
+      from=$(user $(( i % USERS )))
+      push gfatm stablecoin transfer "[\"$from\",\"gfatm\",\"0.0001 GFT\",\"rolling $i\"]" "$from"
+   done
+
+   push gfatm gfatm config "[0,$limits,false]" gfatm
+   for (( i = 0; i < transfers; i++ )); do
+      from=$(user $(( i % USERS )))
+      push gfatm stablecoin transfer "[\"$from\",\"gfatm\",\"0.0001 GFT\",\"calendar $i\"]" "$from"
+   done
+
+   push gfatm gfatm prune '[100]' gfatm
+}
@@ -0,0 +1,24 @@
+# messenger: 1k direct messages to one inbox (inline and hashed bodies),
+# a broadcast to 50 recipients, then the inbox is drained with receiveall.
+workload_msg() {
+   local messages=$(( 1000 / SCALE )) inbox i from long round
+   inbox=$(user 0)
+   long=$(printf 'x%.0s' $(seq 1 200))
+
+   for (( i = 0; i < messages; i++ )); do
+      from=$(user $(( i % (USERS - 1) + 1 )))
+      if (( i % 2 )); then
+         push msg messenger sendmsg "[\"$from\",\"$inbox\",\"message $i\"]" "$from"
+      else
+         push msg messenger sendmsg "[\"$from\",\"$inbox\",\"$long $i\"]" "$from"
+      fi
+   done
+
+   from=$(user 1)
+   push msg messenger broadcast "[\"$from\",$(user_list 0 $(( USERS < 50 ? USERS : 50 ))),\"broadcast\"]" "$from"
+
+   # Each round asks for a different max, so no two drain transactions are identical
+   for (( round = 0; round <= messages / 50 + 1; round++ )); do
+      push msg messenger receiveall "[\"$inbox\",$(( 50 + round ))]" "$inbox"
+   done
+}
@@ -0,0 +1,15 @@
+# mycontract: single saves and upserts, then batches of 10 records.
+workload_mycontract() {
+   local records=$(( 1000 / SCALE )) i
+
+   for (( i = 0; i < records; i++ )); do
+      push mycontract mycontract save "[$i,\"text $i\"]" mycontract
+   done
+   for (( i = 0; i < records; i++ )); do
+      push mycontract mycontract upsert "[$i,\"updated text $i\"]" mycontract
+   done
+   for (( i = 0; i < records / 10; i++ )); do
+      push mycontract mycontract savebatch \
+         "[$(json_list 10 "{\"first\":%d,\"second\":\"batch $i\"}" $(( records + i * 10 )))]" mycontract
+   done
+}
@@ -0,0 +1,26 @@
+# pollgf: a poll with the most options an option id allows (254), 1k votes on it,
+# then a proxy vote carrying a standing delegation from every other user,
+# collected in batches after the vote.
+workload_pollgf() {
+   local votes=$(( 1000 / SCALE )) delegators left batch i owner
+   owner=$(user 0)
+
+   push pollgf pollgf newpoll "[\"bench poll\",\"$owner\",$(json_list 254 '"option %d"'),86400]" "$owner"
+   for (( i = 0; i < votes && i < USERS; i++ )); do
+      push pollgf pollgf vote "[0,\"$(user "$i")\",$(( i % 254 ))]" "$(user "$i")"
+   done
+
+   delegators=$(( USERS - 1 ))
+   push pollgf pollgf regproxy "[\"$owner\",$delegators]" "$owner"
+   for (( i = 1; i <= delegators; i++ )); do
+      push pollgf pollgf setproxy "[\"$(user "$i")\",\"$owner\"]" "$(user "$i")"
+   done
+   push pollgf pollgf newpoll "[\"proxy poll\",\"$owner\",[\"yes\",\"no\"],86400]" "$owner"
+   push pollgf pollgf vote "[1,\"$owner\",0]" "$owner"
+
+   # The vote collected the first 50 (standing_batch); each batch is one larger
+   # than the last, so no two collect pushes are duplicates
+   for (( left = delegators - 50, batch = 100; left > 0; left -= batch, batch++ )); do
+      push pollgf pollgf collect "[1,\"$owner\",$batch]" "$owner"
+   done
+}
@@ -0,0 +1,26 @@
+# stablecoin: 10k transfers between the bench users, plus batched transfers.
+# Senders and recipients rotate over all users, so each transfer touches two balance rows.
+workload_stablecoin() {
+   local transfers=$(( 10000 / SCALE )) i j from to pairs
+
+   push stablecoin stablecoin create '["stablecoin","1000000000.0000 GFT"]' stablecoin
+   push stablecoin stablecoin issue '["stablecoin","10000000.0000 GFT","bench"]' stablecoin
+   for (( i = 0; i < USERS; i++ )); do
+      push stablecoin stablecoin transfer "[\"stablecoin\",\"$(user "$i")\",\"1000.0000 GFT\",\"seed $i\"]" stablecoin
+   done
+
+   for (( i = 0; i < transfers; i++ )); do
+      from=$(user $(( i % USERS )))
+      to=$(user $(( (i + 1 + i % (USERS - 1)) % USERS )))
+      push stablecoin stablecoin transfer "[\"$from\",\"$to\",\"0.0001 GFT\",\"t$i\"]" "$from"
+   done
+
+   for (( i = 0; i < transfers / 100; i++ )); do
+      from=$(user $(( i % USERS )))
+      pairs=""
+      for (( j = 1; j <= 10; j++ )); do
+         pairs+="${pairs:+,}{\"first\":\"$(user $(( (i + 1 + (j - 1) % (USERS - 1)) % USERS )))\",\"second\":\"0.0001 GFT\"}"
+      done
+      push stablecoin stablecoin transferbatch "[\"$from\",[$pairs],\"b$i\"]" "$from"
+   done
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <eosio/eosio.hpp>
+#include <eosio/crypto.hpp>
+#include <optional>
+#include <string>
+
+// Content-addressed, reference-counted storage for large text bodies.
+// Identical bodies are stored once (scope = contract) and rows refer to them by sha256.
+// A new body is billed to the ram_payer of the row that stores it first, so callers
+// can't spend the contract's RAM; it stays billed to them until its last reference is gone.
+namespace content_store {
+
+  // Bodies of at least this many bytes are deduplicated; shorter ones stay inline in the row
+  static constexpr size_t min_size = 256;
+
+  struct [[eosio::table]] body {
+    uint64_t            id;     // Sequence number
+    eosio::checksum256  hash;   // sha256 of text
+    std::string         text;
+    uint64_t            refs;   // Number of rows referring to this body
+
+    uint64_t primary_key() const { return id; }
+    eosio::checksum256 by_hash() const { return hash; }
+  };
+
+  // Bodies, found by their full hash through the byhash index
+  using bodies = eosio::multi_index<"bodies"_n, body,
+    eosio::indexed_by<"byhash"_n, eosio::const_mem_fun<body, eosio::checksum256, &body::by_hash>>
+  >;
+
+  // Add a reference to text, storing it (paid by ram_payer) if it is new. Returns its hash.
+  inline eosio::checksum256 acquire(eosio::name self, eosio::name ram_payer, const std::string& text) {
+    const eosio::checksum256 hash = eosio::sha256(text.data(), text.size());
+
+    bodies table(self, self.value);
+    auto by_hash = table.get_index<"byhash"_n>();
+    auto it = by_hash.find(hash);
+    if (it == by_hash.end()) {
+      table.emplace(ram_payer, [&](auto& b){
+        b.id   = table.available_primary_key();
+        b.hash = hash;
+        b.text = text;
+        b.refs = 1;
+      });
+    } else {
+      by_hash.modify(it, eosio::same_payer, [&](auto& b){
+        b.refs++;
+      });
+    }
+    return hash;
+  }
+
+  // Drop a reference to a body, erasing it with the last one.
+  inline void release(eosio::name self, const eosio::checksum256& hash) {
+    bodies table(self, self.value);
+    auto by_hash = table.get_index<"byhash"_n>();
+    auto it = by_hash.find(hash);
+    eosio::check(it != by_hash.end(), "Content body not found");
+    if (it->refs <= 1) {
+      by_hash.erase(it);
+    } else {
+      by_hash.modify(it, eosio::same_payer, [&](auto& b){
+        b.refs--;
+      });
+    }
+  }
+
+  // Store text in a row's (inline_text, ref) pair: inline below min_size, otherwise by reference,
+  // a new body being paid by ram_payer. Any body the row referred to before is released.
+  inline void assign(eosio::name self, eosio::name ram_payer, const std::string& text,
+                     std::string& inline_text, std::optional<eosio::checksum256>& ref) {
+    std::optional<eosio::checksum256> old_ref = ref;
+    if (text.size() < min_size) {
+      inline_text = text;
+      ref.reset();
+    } else {
+      inline_text.clear();
+      ref = acquire(self, ram_payer, text);
+    }
+    if (old_ref) {
+      release(self, *old_ref);
+    }
+  }
+}
@@ -7,23 +7,79 @@ void database::create(name user, string title, string content) {
   check(title.size()   <= 128,  "Title too long");
   check(content.size() <= 4096, "Content too long");
 
-  das datable(get_self(), get_self().value);
+  counters cnt(get_self(), user.value);
+  auto c = cnt.get_or_default();
+  const uint64_t post_id = c.next_post_id++;
+  cnt.set(c, user);
+
+  das datable(get_self(), user.value);
   datable.emplace(user, [&](auto& d){
-    d.post_id = datable.available_primary_key();
+    d.post_id = post_id;
     d.poster  = user;
     d.title   = title;
-    d.content = content;
+    content_store::assign(get_self(), user, content, d.content, d.content_ref);
+  });
+}
+
+void database::update(name user, uint64_t post_id, std::optional<string> title, std::optional<string> content) {
+  require_auth(user);
+  check(title || content, "Nothing to update");
+  if (title) {
+    check(!title->empty(),  "Title cannot be empty");
+    check(title->size() <= 128, "Title too long");
+  }
+  if (content) {
+    check(!content->empty(), "Content cannot be empty");
+    check(content->size() <= 4096, "Content too long");
+  }
+
+  das datable(get_self(), user.value);
+  auto it = datable.find(post_id);
+  check(it != datable.end(), "Post not found");
+  datable.modify(it, same_payer, [&](auto& d){
+    if (title)   d.title   = std::move(*title);
+    if (content) content_store::assign(get_self(), user, *content, d.content, d.content_ref);
   });
 }
 
 void database::erase(name user, uint64_t post_id) {
   require_auth(user);
-  das datable(get_self(), get_self().value);
+  das datable(get_self(), user.value);
   auto it = datable.find(post_id);
   check(it != datable.end(), "Post not found");
   check(it->poster == user, "Only the poster can delete their post");
+  if (it->content_ref) {
+    content_store::release(get_self(), *it->content_ref);
+  }
   datable.erase(it);
 }
 
+void database::migrate(name user, uint64_t max_rows) {
+  require_auth(user);
+  check(max_rows > 0, "max_rows must be positive");
+
+  legacy_das legacy(get_self(), get_self().value);
+  auto byposter = legacy.get_index<"byposter"_n>();
+  auto it = byposter.lower_bound(user.value);
+  check(it != byposter.end() && it->poster == user, "No legacy posts to migrate");
+
+  counters cnt(get_self(), user.value);
+  auto c = cnt.get_or_default();
+
+  // Same poster: index order is primary key order, i.e. creation order
+  das datable(get_self(), user.value);
+  for (uint64_t moved = 0; moved < max_rows && it != byposter.end() && it->poster == user; ++moved) {
+    const uint64_t post_id = c.next_post_id++;
+    datable.emplace(user, [&](auto& d){
+      d.post_id = post_id;
+      d.poster  = user;
+      d.title   = it->title;
+      content_store::assign(get_self(), user, it->content, d.content, d.content_ref);
+    });
+    it = byposter.erase(it);
+  }
+  cnt.set(c, user);
+}
+
 // Keep dispatcher in the same TU
-EOSIO_DISPATCH(database, (create)(erase))
+EOSIO_DISPATCH(database, (create)(update)(erase)(migrate))
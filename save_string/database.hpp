@@ -1,5 +1,8 @@
 #pragma once
 #include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
+#include "content_store.hpp"
+#include <optional>
 #include <string>
 using namespace eosio;
 using std::string;
@@ -13,24 +16,57 @@ public:
   [[eosio::action]]
   void create(name user, string title, string content);
 
+  // Edit a post in place; only the provided fields are changed
+  [[eosio::action]]
+  void update(name user, uint64_t post_id, std::optional<string> title, std::optional<string> content);
+
   // Delete a post by id (only the author can delete)
   [[eosio::action]]
   void erase(name user, uint64_t post_id);
 
-  // Posts table
+  // Move up to max_rows of user's posts from the legacy contract-wide table into
+  // user's own scope. Upgrade note: posts created before per-poster scopes stay in
+  // the contract's scope until their poster runs this; they get new per-poster
+  // ids, in their original order, and the poster's RAM moves with them.
+  [[eosio::action]]
+  void migrate(name user, uint64_t max_rows);
+
+  // Posts table (scope = poster)
   struct [[eosio::table]] da {
-    uint64_t post_id;   // Auto-increment ID
+    uint64_t post_id;   // Per-poster sequence number
     name     poster;    // Author
     string   title;
+    string   content;       // Inline content (short posts only)
+    std::optional<checksum256> content_ref; // Hash of deduplicated content in content_store::bodies
+
+    uint64_t primary_key() const { return post_id; }
+  };
+
+  // A poster's posts, in creation order: get_table_rows with scope = poster,
+  // paging by lower_bound = last seen post_id + 1
+  using das = multi_index<"data"_n, da>;
+
+  // Next post id of a poster (scope = poster)
+  struct [[eosio::table]] counter {
+    uint64_t next_post_id = 0;
+  };
+
+  using counters = singleton<"counter"_n, counter>;
+
+  // Post of the legacy contract-wide table (scope = contract, global ids).
+  // Shares the "data" table name, so it is not part of the ABI; read only by migrate.
+  struct legacy_da {
+    uint64_t post_id;
+    name     poster;
+    string   title;
     string   content;
 
     uint64_t primary_key() const { return post_id; }
     uint64_t byposter()    const { return poster.value; }
   };
 
-  // Index by author for querying: get_index<"byposter"_n>()
-  using das = multi_index<
-    "data"_n, da,
-    indexed_by<"byposter"_n, const_mem_fun<da, uint64_t, &da::byposter>>
+  using legacy_das = multi_index<
+    "data"_n, legacy_da,
+    indexed_by<"byposter"_n, const_mem_fun<legacy_da, uint64_t, &legacy_da::byposter>>
   >;
 };
@@ -2,39 +2,125 @@
 
 /**
  * Action: set configuration.
- * For fixed 10,000 GFT/day logic, this does nothing. Only here for ABI compatibility.
+ * Stores the timezone and the list of limited tokens in the config singleton,
+ * so limits can be changed without redeploying the contract.
  */
-void gfatm::config(int8_t timezone, uint64_t daily_limit)
+void gfatm::config(int8_t timezone, vector<token_limit> limits, bool rolling_window)
 {
-    // Not implemented (static logic).
-    // To implement dynamic config, use require_auth(_self) and a singleton.
+    require_auth(_self);
+
+    check(timezone >= -12 && timezone <= 14, "Invalid timezone offset");
+    check(limits.size() <= MAX_LIMITED_TOKENS, "Too many limited tokens");
+
+    for (size_t i = 0; i < limits.size(); ++i) {
+        check(limits[i].token.get_symbol().is_valid(), "Invalid limited token symbol");
+        for (size_t j = 0; j < i; ++j) {
+            check(!(limits[j].token == limits[i].token), "Duplicate limited token");
+            check(withdrawal_scope(limits[j].token) != withdrawal_scope(limits[i].token),
+                  "Limited tokens share a withdrawal scope");
+        }
+    }
+
+    tbl_config cfg(_self, _self.value);
+    cfg.set(config_info{timezone, limits, rolling_window}, _self);
 }
 
 /**
- * @brief Handler for incoming transfers (typically called via inline transfer).
- * If sender is not self (i.e., an external user is withdrawing from ATM), enforce daily withdrawal limit.
- * Only GFT tokens from gft.token contract are processed—others are ignored.
+ * Action: prune stale withdrawal rows.
+ * Walks the byday index of each limited token from the oldest row and stops at the
+ * first row that is still relevant, so the sweep never scans live rows.
+ * A row whose last withdrawal day is before yesterday holds neither a current-day
+ * total nor any bucket of the 24-hour window, so erasing it changes no limit.
  */
-void gfatm::handle_transfer(account_name from, account_name to, extended_asset quantity, string memo)
+void gfatm::prune(uint64_t max_rows)
 {
-    // Ignore outgoing transfers or non-GFT tokens
-    if (from == _self) return;
+    check(max_rows > 0, "max_rows must be positive");
 
-    // Only enforce for GFT token withdrawals
-    if (quantity.contract != GFT_TOKEN_CONTRACT || quantity.quantity.symbol != GFT_SYMBOL)
+    const config_info cfg = get_config();
+    const uint32_t today = current_day(cfg.timezone);
+    if (today < 2)
         return;
+    const uint32_t stale_before = today - 1;
+
+    uint64_t budget = max_rows;
+    for (const auto& limit : cfg.limits) {
+        withdrawals_table wtable(_self, withdrawal_scope(limit.token));
+        auto by_day = wtable.get_index<"byday"_n>();
+
+        auto itr = by_day.begin();
+        while (budget > 0 && itr != by_day.end() && itr->last_withdraw_day < stale_before) {
+            itr = by_day.erase(itr);
+            --budget;
+        }
+        if (budget == 0)
+            break;
+    }
+}
+
+/**
+ * @brief Handler for incoming transfers (typically called via inline transfer).
+ * If sender is not self (i.e., an external user is withdrawing from ATM), enforce daily withdrawal limit,
+ * either per calendar day or over a rolling 24-hour window (config.rolling_window).
+ * Only tokens listed in the config are processed—others are ignored.
+ */
+void gfatm::handle_transfer(name from, name to, extended_asset quantity, const config_info& cfg)
+{
+    // Ignore outgoing transfers
+    if (from == _self) return;
 
     // Ignore zero or negative transfers
     if (quantity.quantity.amount <= 0)
         return;
 
-    // Get current UTC day number
-    uint32_t today = current_day();
+    // Only enforce for limited token withdrawals
+    const token_limit* limit = find_limit(cfg, quantity.get_extended_symbol());
+    if (limit == nullptr)
+        return;
 
-    // Open withdrawals table in contract scope
-    withdrawals_table wtable(_self, _self.value);
+    gf_instrumentation::probe probe("transfer"_n.value);
+    probe.read(); // the config, read by apply() and passed in
+
+    // Get current day number in the configured timezone
+    uint32_t today = current_day(cfg.timezone);
+
+    // Open withdrawals table in the token's scope
+    withdrawals_table wtable(_self, withdrawal_scope(limit->token));
+
+    auto witr = wtable.find(from.value);
+    probe.read();
+
+    // Sliding window: hourly buckets updated in place, no reset spike at midnight
+    if (cfg.rolling_window) {
+        const uint32_t hour = current_time_point().sec_since_epoch() / 3600;
+
+        withdrawal row = (witr != wtable.end()) ? *witr : withdrawal{from};
+        if (row.hourly.empty()) {
+            // New row, or last written in calendar day mode: start the window with that day's total
+            row.hourly.assign(WINDOW_HOURS, 0);
+            if (row.last_withdraw_day == today)
+                row.hourly[hour % WINDOW_HOURS] = row.amount_withdrawn;
+            row.last_withdraw_hour = hour;
+        }
+        uint64_t window_total = advance_window(row, hour) + quantity.quantity.amount;
+
+        check(window_total <= limit->daily_limit, "24-hour withdrawal limit exceeded for this account");
+
+        row.hourly[hour % WINDOW_HOURS] += quantity.quantity.amount;
+
+        // Keep the calendar day total current too, for a later switch of modes
+        row.amount_withdrawn = (row.last_withdraw_day == today ? row.amount_withdrawn : 0) + quantity.quantity.amount;
+        row.last_withdraw_day = today;
+
+        if (witr == wtable.end()) {
+            witr = wtable.emplace(_self, [&](auto& r) { r = row; });
+        } else {
+            wtable.modify(witr, _self, [&](auto& r) { r = row; });
+        }
+        probe.write(*witr);
+        probe.emit(_self, "log"_n);
+        return;
+    }
 
-    auto witr = wtable.find(from);
     uint64_t already_withdrawn = 0;
     uint32_t user_day = 0;
 
@@ -51,11 +137,11 @@ void gfatm::handle_transfer(account_name from, account_name to, extended_asset q
     uint64_t new_total = already_withdrawn + quantity.quantity.amount;
 
     // Enforce per-day withdrawal limit
-    check(new_total <= DAILY_LIMIT, "Daily withdrawal limit of 10,000 GFT exceeded for this account");
+    check(new_total <= limit->daily_limit, "Daily withdrawal limit exceeded for this account");
 
     // Record/update withdrawal
     if (witr == wtable.end()) {
-        wtable.emplace(_self, [&](auto& row) {
+        witr = wtable.emplace(_self, [&](auto& row) {
             row.account = from;
             row.amount_withdrawn = quantity.quantity.amount;
             row.last_withdraw_day = today;
@@ -64,16 +150,100 @@ void gfatm::handle_transfer(account_name from, account_name to, extended_asset q
         wtable.modify(witr, _self, [&](auto& row) {
             row.amount_withdrawn = quantity.quantity.amount;
             row.last_withdraw_day = today;
+            row.hourly.clear(); // calendar rows don't carry the ring
         });
     } else {
         wtable.modify(witr, _self, [&](auto& row) {
             row.amount_withdrawn = new_total;
             // last_withdraw_day remains the same
+            row.hourly.clear();
         });
     }
+    probe.write(*witr);
+    probe.emit(_self, "log"_n);
 
     // Process the withdrawal as normal (i.e., transfer will succeed)
     // Any payout logic or actual token release should happen here if needed.
 
     // NOTE: If excess, check() above will revert and the withdrawal will fail.
-}
\ No newline at end of file
+}
+
+/**
+ * Read the config singleton.
+ * Until config() is called, only LIMITING_TOKEN is limited, at DEFAULT_DAILY_LIMIT, in UTC.
+ */
+gfatm::config_info gfatm::get_config()
+{
+    tbl_config cfg(_self, _self.value);
+    if (cfg.exists())
+        return cfg.get();
+
+    return config_info{0, {token_limit{LIMITING_TOKEN, DEFAULT_DAILY_LIMIT}}, false};
+}
+
+/**
+ * Linear search of the (small) limits vector by token contract.
+ */
+bool gfatm::is_limited_contract(const config_info& cfg, name token_contract)
+{
+    for (const auto& limit : cfg.limits) {
+        if (limit.token.get_contract() == token_contract)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Linear search of the (small) limits vector.
+ */
+const gfatm::token_limit* gfatm::find_limit(const config_info& cfg, const extended_symbol& token)
+{
+    for (const auto& limit : cfg.limits) {
+        if (limit.token == token)
+            return &limit;
+    }
+    return nullptr;
+}
+
+/**
+ * Mixes the token contract and symbol code into one 64-bit scope.
+ * config() rejects limits whose scopes collide, so limited tokens never share rows.
+ */
+uint64_t gfatm::withdrawal_scope(const extended_symbol& token)
+{
+    uint64_t h = token.get_contract().value ^ (token.get_symbol().code().raw() * 0x9e3779b97f4a7c15ULL);
+    h = (h ^ (h >> 33)) * 0xff51afd7ed558ccdULL;
+    return h ^ (h >> 33);
+}
+
+/**
+ * Day number since the epoch, with day boundaries at midnight of the given timezone.
+ */
+uint32_t gfatm::current_day(int8_t timezone)
+{
+    int64_t local_time = static_cast<int64_t>(current_time_point().sec_since_epoch()) + static_cast<int64_t>(timezone) * 3600;
+    return static_cast<uint32_t>(local_time / 86400);
+}
+
+/**
+ * Moves the window of the row forward to end at hour.
+ * Buckets of hours that fell out of the window are zeroed, so at most
+ * WINDOW_HOURS buckets are touched however long the account was idle.
+ */
+uint64_t gfatm::advance_window(withdrawal& row, uint32_t hour)
+{
+    if (hour - row.last_withdraw_hour >= WINDOW_HOURS) {
+        row.hourly.assign(WINDOW_HOURS, 0);
+    } else {
+        for (uint32_t h = row.last_withdraw_hour + 1; h <= hour; ++h) {
+            row.hourly[h % WINDOW_HOURS] = 0;
+        }
+    }
+    row.last_withdraw_hour = hour;
+
+    uint64_t total = 0;
+    for (const auto amount : row.hourly) {
+        total += amount;
+    }
+    return total;
+}
@@ -1,95 +1,208 @@
 #pragma once
 
-#include <eosiolib/eosio.hpp>
-#include <eosiolib/asset.hpp>
-#include <eosiolib/singleton.hpp>
+#include <eosio/eosio.hpp>
+#include <eosio/asset.hpp>
+#include <eosio/singleton.hpp>
+#include <eosio/system.hpp>
 #include <string>
+#include <vector>
+
+#include "instrumentation.hpp"
 
 using namespace std;
 using namespace eosio;
 
 /**
  * Structure for unpacking data from transfer (from standard GF token).
+ * Only the fixed-size head is unpacked; the trailing memo is never deserialized.
  */
-struct transfer_args
+struct transfer_head
 {
-    account_name from;     // Sender account
-    account_name to;       // Recipient account
+    name from;             // Sender account
+    name to;               // Recipient account
     asset quantity;        // Amount of tokens
-    string memo;           // Arbitrary memo/message
 };
 
+// Packed size of transfer_head: two names, asset amount and symbol
+static const uint32_t TRANSFER_HEAD_SIZE = 4 * sizeof(uint64_t);
+
 /**
  * Main contract class: GF ATM.
  * This contract is intended to service token operations (for example, withdrawal limits and working timezone).
  */
-class gfatm : public contract
+class [[eosio::contract("gfatm")]] gfatm : public contract
 {
   public:
     using contract::contract;
 
     // The token symbol and contract for which operations are limited (by default, GFT)
-    const extended_symbol LIMITING_TOKEN = extended_symbol(S(4, GFT), N(eosio.token));
+    const extended_symbol LIMITING_TOKEN = extended_symbol(symbol("GFT", 4), "eosio.token"_n);
+
+    // Default daily limit for LIMITING_TOKEN until a config is set (10,000 GFT in 4-decimal format)
+    static const uint64_t DEFAULT_DAILY_LIMIT = 10000 * 10000;
+
+    // Maximum number of limited tokens in the config
+    static const size_t MAX_LIMITED_TOKENS = 8;
+
+    // Length of the rolling withdrawal window, in hourly buckets
+    static const uint32_t WINDOW_HOURS = 24;
 
     /**
-     * Structure for storing contract configuration:
-     * - timezone: working timezone of the ATM (for example, to restrict operation by time of day)
-     * - daily_limit: daily withdrawal limit (in token units)
-     * Used as a singleton — only one config record per contract.
+     * Withdrawal limit of one token.
      */
-    struct config_info
+    struct token_limit
     {
-        int8_t timezone;         // Time zone offset (e.g., GMT+3 = 3)
+        extended_symbol token;   // Limited token (symbol + contract)
         uint64_t daily_limit;    // Daily limit (e.g., 10000 = 1 GFT in 4-decimal format)
+
+        EOSLIB_SERIALIZE(token_limit, (token)(daily_limit))
+    };
+
+    /**
+     * Structure for storing contract configuration:
+     * - timezone: working timezone of the ATM (day boundaries are local midnight)
+     * - limits: withdrawal limits, one entry per limited token (small flat vector)
+     * - rolling_window: limit withdrawals over the last 24 hours instead of per calendar day
+     * Used as a singleton — only one config record per contract, read once per notification.
+     */
+    struct [[eosio::table("config")]] config_info
+    {
+        int8_t timezone;             // Time zone offset (e.g., GMT+3 = 3)
+        vector<token_limit> limits;  // Limited tokens and their daily limits
+        bool rolling_window;         // True for sliding 24-hour window mode
+
+        EOSLIB_SERIALIZE(config_info, (timezone)(limits)(rolling_window))
     };
 
     // Singleton to store the configuration
-    typedef singleton<N(config), config_info> tbl_config;
+    typedef singleton<"config"_n, config_info> tbl_config;
+
+    /**
+     * Per-account withdrawal counter for one token (scope = withdrawal_scope of the token,
+     * so tokens sharing a symbol name in different contracts keep separate counters).
+     * amount_withdrawn is the total of last_withdraw_day in both modes, so switching
+     * modes never reads a stale total. Rolling window mode also keeps a ring of
+     * WINDOW_HOURS hourly buckets; calendar day rows store the ring empty.
+     * Buckets are 64-bit like the limits, so any configured daily limit works in both modes.
+     */
+    struct [[eosio::table("withdrawals")]] withdrawal
+    {
+        name account;                               // Withdrawing account
+        uint64_t amount_withdrawn = 0;              // Amount withdrawn on last_withdraw_day
+        uint32_t last_withdraw_day = 0;             // Day number (in config timezone) of the last withdrawal
+        uint32_t last_withdraw_hour = 0;            // Hour number (since epoch) of the last withdrawal
+        vector<uint64_t> hourly;                    // Rolling mode: amount withdrawn per hour, indexed by hour % WINDOW_HOURS
+
+        uint64_t primary_key() const { return account.value; }
+
+        // Index for the prune sweep: oldest withdrawals first
+        uint64_t by_day() const { return last_withdraw_day; }
+
+        EOSLIB_SERIALIZE(withdrawal, (account)(amount_withdrawn)(last_withdraw_day)(last_withdraw_hour)(hourly))
+    };
+
+    typedef multi_index<"withdrawals"_n, withdrawal,
+        indexed_by<"byday"_n, const_mem_fun<withdrawal, uint64_t, &withdrawal::by_day>>
+    > withdrawals_table;
 
     /**
-     * Action: set the configuration (timezone and limit).
+     * Action: set the configuration (timezone, per-token limits and window mode).
      * Can be called only by the contract owner.
      */
-    void config(int8_t timezone, uint64_t daily_limit);
+    [[eosio::action]]
+    void config(int8_t timezone, vector<token_limit> limits, bool rolling_window);
+
+    /**
+     * Action: erase up to max_rows stale withdrawal rows of the limited tokens.
+     * A row is stale once its last withdrawal is more than a full day old, so it no
+     * longer affects any limit. Anyone can call it.
+     */
+    [[eosio::action]]
+    void prune(uint64_t max_rows);
 
     /**
      * Handler for incoming transfers.
      * Used for accounting, enforcing limits, etc.
-     * from — sender, to — recipient, quantity — amount, memo — arbitrary message.
+     * from — sender, to — recipient, quantity — amount, cfg — config already read by apply().
+     */
+    void handle_transfer(name from, name to, extended_asset quantity, const config_info& cfg);
+
+#ifdef GF_INSTRUMENTATION
+    /**
+     * Action: no-op sink for the cost counters of handle_transfer, sent inline by the contract.
      */
-    void handle_transfer(account_name from, account_name to, extended_asset quantity, string memo);
+    [[eosio::action]]
+    void log(const gf_instrumentation::counters& event) {}
+#endif
+
+    // Returns the stored config, or the default (LIMITING_TOKEN only) if none is set.
+    config_info get_config();
+
+    // True if any limited token is issued by the token contract.
+    static bool is_limited_contract(const config_info& cfg, name token_contract);
+
+  private:
+    // Returns the limit entry for a token, or nullptr if the token is not limited.
+    static const token_limit* find_limit(const config_info& cfg, const extended_symbol& token);
+
+    // Scope of the withdrawal rows of a token: a hash of its contract and symbol code.
+    static uint64_t withdrawal_scope(const extended_symbol& token);
+
+    // Current day number in the configured timezone.
+    static uint32_t current_day(int8_t timezone);
+
+    // Clears buckets that left the window ending at hour, returns the amount still in the window.
+    static uint64_t advance_window(withdrawal& row, uint32_t hour);
 };
 
 /**
  * ABI section (C-style apply), necessary for correct GF action routing.
  * - If action's code matches the contract — dispatch actions via GF_API.
- * - If a standard transfer is received from another contract (e.g., eosio.token) — call handle_transfer.
+ * - If a standard transfer is received from another contract (e.g., eosio.token) — call handle_transfer,
+ *   but only for limited token contracts, so notifications from any other contract (airdrop spam)
+ *   return before any action data is read.
  */
 extern "C"
 {
+    [[eosio::wasm_entry]]
     void apply(uint64_t receiver, uint64_t code, uint64_t action)
     {
-        auto self = receiver;
-        gfatm thiscontract(self);
+        gfatm thiscontract(name(receiver), name(code), datastream<const char*>(nullptr, 0));
 
-        // Action call (e.g., config)
-        if (code == self)
+        // Action call (e.g., config, prune)
+        if (code == receiver)
         {
             switch (action)
             {
-                EOSIO_API(gfatm, (config))
+#ifdef GF_INSTRUMENTATION
+                EOSIO_DISPATCH_HELPER(gfatm, (config)(prune)(log))
+#else
+                EOSIO_DISPATCH_HELPER(gfatm, (config)(prune))
+#endif
             }
         }
         // Handling incoming transfer
-        else if (action == N(transfer))
+        else if (action == "transfer"_n.value)
         {
-            // Unpack transfer arguments
-            auto transfer_data = unpack_action_data<transfer_args>();
+            // Config is read once and shared with the handler
+            const gfatm::config_info cfg = thiscontract.get_config();
+            if (!gfatm::is_limited_contract(cfg, name(code)))
+                return;
+
+            // Unpack only the head of the transfer arguments (memo is skipped)
+            char buffer[TRANSFER_HEAD_SIZE];
+            if (read_action_data(buffer, TRANSFER_HEAD_SIZE) < TRANSFER_HEAD_SIZE)
+                return;
+
+            transfer_head transfer_data;
+            datastream<const char*> ds(buffer, TRANSFER_HEAD_SIZE);
+            ds >> transfer_data;
+
             thiscontract.handle_transfer(
                 transfer_data.from,
                 transfer_data.to,
-                extended_asset(transfer_data.quantity, code),
-                transfer_data.memo
+                extended_asset(transfer_data.quantity, name(code)),
+                cfg
             );
         }
     }
@@ -0,0 +1,63 @@
+#pragma once
+#include <eosio/action.hpp>
+#include <eosio/name.hpp>
+#include <eosio/serialize.hpp>
+#include <cstdint>
+#include <vector>
+
+// Opt-in cost counters for hot paths, reported as an inline no-op "log" action
+// that indexers can pick up from the action trace.
+// Everything here compiles to nothing unless GF_INSTRUMENTATION is defined.
+// Contracts count next to each real table operation: one read per lookup (find, get,
+// begin), one write per emplace, modify or erase, with the packed size of the row as
+// stored (0 for an erase).
+namespace gf_instrumentation {
+
+  // Payload of the log action
+  struct counters {
+    uint64_t path = 0;          // Name of the instrumented action
+    uint32_t rows_read = 0;     // Table lookups
+    uint32_t rows_written = 0;  // Rows emplaced, modified or erased
+    uint32_t bytes_written = 0; // Packed size of the rows written
+
+    EOSLIB_SERIALIZE(counters, (path)(rows_read)(rows_written)(bytes_written))
+  };
+
+  // Counters of one action
+  class probe {
+  public:
+#ifdef GF_INSTRUMENTATION
+    explicit probe(uint64_t path) { _counters.path = path; }
+
+    void read(uint32_t rows = 1) { _counters.rows_read += rows; }
+
+    void write(uint32_t rows, uint32_t bytes) {
+      _counters.rows_written += rows;
+      _counters.bytes_written += bytes;
+    }
+
+    template<typename Row>
+    void write(const Row& row) { write(1, eosio::pack_size(row)); }
+
+    // Send the counters to the contract's log action. No authorization is attached,
+    // so the contract does not need eosio.code permission.
+    void emit(eosio::name self, eosio::name log_action) const {
+      eosio::action(std::vector<eosio::permission_level>(), self, log_action, _counters).send();
+    }
+
+  private:
+    counters _counters;
+#else
+    explicit probe(uint64_t) {}
+
+    void read(uint32_t = 1) {}
+
+    void write(uint32_t, uint32_t) {}
+
+    template<typename Row>
+    void write(const Row&) {}
+
+    void emit(eosio::name, eosio::name) const {}
+#endif
+  };
+}
@@ -2,17 +2,26 @@
  *  @file
  *  EOSIO Messenger Contract
  *  Enables sending, receiving, and deleting private messages on chain.
+ *
+ *  Upgrading from the single-table layout (notifications in the contract's scope,
+ *  ids from one global counter): deploy, then call migrate until it reports that
+ *  the migration is complete. Until then sendmsg and broadcast are rejected, so no
+ *  new id can collide with a legacy one. Legacy rows are re-stored at the contract's
+ *  expense. On a fresh deployment a single migrate call just records that there
+ *  is nothing to migrate.
  */
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 #include <string>
-#include <eosiolib/eosio.hpp>        // EOSIO contract base class and macros
-#include <eosiolib/asset.hpp>        // For asset types (not used in this contract)
-#include <eosiolib/contract.hpp>     // EOSIO contract base
-#include <eosiolib/time.hpp>         // EOSIO time and time_point_sec
-#include <eosiolib/print.hpp>        // EOSIO print for debugging (not used in production)
-#include <eosiolib/transaction.hpp>  // For inline/deferred transactions (not used here)
+#include <variant>
+#include <eosio/eosio.hpp>           // EOSIO contract base class and macros
+#include <eosio/system.hpp>          // Current block time
+#include <eosio/time.hpp>            // EOSIO time and time_point_sec
+#include <eosio/crypto.hpp>          // sha256 for off-loaded message bodies
+#include <eosio/singleton.hpp>       // Contract configuration
+#include "instrumentation.hpp"       // Opt-in cost counters (GF_INSTRUMENTATION)
 
 using namespace eosio;
 
@@ -20,53 +29,173 @@ using namespace eosio;
  * @class messenger
  * Implements a simple on-chain messenger with message sending, receiving, and deletion.
  */
-class messenger : public eosio::contract
+class [[eosio::contract("messenger")]] messenger : public eosio::contract
 {
 public:
   using contract::contract;
 
-  // Contract constructor
-  messenger(account_name self) : contract(self) {}
+  // Recipient recorded on broadcast messages, which have many recipients
+  static constexpr name BROADCAST{};
+
+  /**
+   * @brief Set the contract configuration.
+   * - Only the contract account can call this action.
+   * @param inline_limit  Bodies up to this many bytes are stored on chain, larger ones only as a hash
+   * @param max_size      Maximum message body size in bytes
+   */
+  [[eosio::action]]
+  void setconfig(uint32_t inline_limit, uint32_t max_size)
+  {
+    require_auth(_self);
+
+    check(max_size > 0, "Maximum message size must be positive");
+    check(inline_limit <= max_size, "Inline limit cannot exceed maximum message size");
+
+    config_info cfg = get_config();
+    cfg.inline_limit = inline_limit;
+    cfg.max_size = max_size;
+    config_table config(_self, _self.value);
+    config.set(cfg, _self);
+  }
+
+  /**
+   * @brief Move up to max_rows legacy messages to the per-account layout.
+   * - Each legacy notification (contract scope) becomes a notification in the
+   *   recipient's inbox; its message is re-stored in the new format under the same id.
+   * - Legacy messages addressed to the contract itself are dropped: the contract has no inbox.
+   * - New sender sequences start above the largest legacy id.
+   * - Only the contract account can call this action; it pays for the re-stored rows.
+   * @param max_rows  Maximum number of legacy messages to move in this call
+   */
+  [[eosio::action]]
+  void migrate(uint64_t max_rows)
+  {
+    require_auth(_self);
+
+    check(max_rows > 0, "max_rows must be positive");
+
+    config_info cfg = get_config();
+    check(!cfg.migrated, "Migration is already complete");
+
+    legacy_notification_table legacy(_self, _self.value);
+    if (legacy.begin() != legacy.end())
+    {
+      auto last = legacy.end();
+      --last;
+      cfg.id_floor = std::max(cfg.id_floor, last->id + 1);
+    }
+
+    uint64_t moved = 0;
+    auto itr = legacy.begin();
+    while (moved < max_rows && itr != legacy.end())
+    {
+      legacy_message_table legacy_messages(_self, itr->from.value);
+      auto itr_msg = legacy_messages.find(itr->id);
+      if (itr_msg != legacy_messages.end())
+      {
+        const legacy_message old = *itr_msg;
+        legacy_messages.erase(itr_msg);
+
+        if (itr->to != _self)
+        {
+          const uint64_t notif_id = store_notification(itr->from, old.id, itr->to,
+                                                       old.send_at.sec_since_epoch(), _self);
+          message_table messages(_self, itr->from.value);
+          messages.emplace(_self, [&](auto &m) {
+            m.id = old.id;
+            m.to = itr->to;
+            m.body = old.text;
+            m.send_at = old.send_at;
+            m.ref = notif_id;
+          });
+        }
+      }
+
+      itr = legacy.erase(itr);
+      ++moved;
+    }
+
+    cfg.migrated = itr == legacy.end();
+    config_table config(_self, _self.value);
+    config.set(cfg, _self);
+
+    print(cfg.migrated ? "Migration complete" : "Migration in progress");
+  }
 
   /**
    * @brief Send a message from one account to another.
-   * - Stores a notification and a message record on chain.
+   * - Stores a notification (in the recipient's inbox) and a message record (in the sender's outbox).
    * - The notification enables the recipient to find new incoming messages.
+   * - The message id comes from the sender's own sequence. The notification id is
+   *   derived from the send time and the sender's message id, so no row shared
+   *   by everyone writing to the same recipient is modified.
+   * - Bodies longer than the configured inline limit are stored as a sha256 hash only;
+   *   the full text stays available in the sendmsg action trace (history nodes).
    * @param from  Sender account (must authorize)
    * @param to    Recipient account
    * @param msg   Message text (must not be empty)
-   * @abi action
    */
-  void sendmsg(const account_name from,
-               const account_name to,
+  [[eosio::action]]
+  void sendmsg(const name from,
+               const name to,
                const std::string msg)
   {
     require_auth(from);  // Ensure sender authorized
+    _probe = gf_instrumentation::probe("sendmsg"_n.value);
 
-    eosio_assert(msg.size() > 0, "Empty message");
-
-    // (Optional) Check that recipient account "to" exists
+    // The recipient must exist; this also rules out BROADCAST, the empty name
+    check(is_account(to), "Recipient account does not exist");
+    check(to != _self, "Cannot send messages to the contract");
 
-    notification_table notifications(_self, _self); // Notifications table (global scope)
-    message_table messages(_self, from);            // Messages table (scoped to sender)
+    const config_info cfg = get_config();
+    check(cfg.migrated, "Legacy messages are not migrated yet");
 
-    uint64_t newid = notifications.available_primary_key(); // Unique message/notification id
+    const uint64_t msg_id = next_id(from, cfg); // Unique id in sender's outbox
 
     // Add a notification for the recipient (so they can find new messages)
-    notifications.emplace(from, [&](auto &n) {
-      n.id = newid;
-      n.from = from;
-      n.to = to;
-    });
+    const uint64_t notif_id = store_notification(from, msg_id, to, current_time_point().sec_since_epoch(), from);
 
-    // Store the actual message (including text and timestamp)
-    messages.emplace(from, [&](auto &m) {
-      m.id = newid;
-      m.to = to;
-      m.text = msg;
-      m.send_at = eosio::time_point_sec(now());
-      m.type = 0; // Reserved for future message type expansion
-    });
+    // Store the actual message (text or its hash, and timestamp)
+    store_message(cfg, from, msg_id, to, notif_id, msg);
+    _probe.emit(_self, "log"_n);
+  }
+
+  /**
+   * @brief Send one message to many recipients.
+   * - The message body is stored once in the sender's outbox, reference-counted.
+   * - Each recipient gets a lightweight notification pointing to it.
+   * - The body is freed when the last recipient receives it.
+   * @param from  Sender account (must authorize)
+   * @param to    Recipient accounts
+   * @param msg   Message text (must not be empty)
+   */
+  [[eosio::action]]
+  void broadcast(const name from,
+                 const std::vector<name> to,
+                 const std::string msg)
+  {
+    require_auth(from);
+
+    check(to.size() > 0, "No recipients");
+
+    _probe = gf_instrumentation::probe("broadcast"_n.value);
+
+    const config_info cfg = get_config();
+    check(cfg.migrated, "Legacy messages are not migrated yet");
+
+    const uint64_t msg_id = next_id(from, cfg);
+
+    const uint32_t send_at = current_time_point().sec_since_epoch();
+    for (const auto &recipient : to)
+    {
+      check(is_account(recipient), "Recipient account does not exist");
+      check(recipient != _self, "Cannot send messages to the contract");
+      store_notification(from, msg_id, recipient, send_at, from);
+    }
+
+    // Broadcast bodies have no single recipient
+    store_message(cfg, from, msg_id, BROADCAST, to.size(), msg);
+    _probe.emit(_self, "log"_n);
   }
 
   /**
@@ -74,107 +203,383 @@ public:
    * - The notification and message are deleted.
    * - Only the recipient can call this action.
    * @param to  The recipient account (must authorize)
-   * @param id  The message/notification id
-   * @abi action
+   * @param id  The notification id in the recipient's inbox
    */
-  void receivemsg(const account_name to, uint64_t id)
+  [[eosio::action]]
+  void receivemsg(const name to, uint64_t id)
   {
     require_auth(to);
 
-    notification_table notifications(_self, _self);
+    notification_table notifications(_self, to.value); // Recipient's inbox
     auto itr_notif = notifications.find(id);
-    eosio_assert(itr_notif != notifications.end(), "Notification not found");
+    check(itr_notif != notifications.end(), "Notification not found");
     const auto &notif = *itr_notif;
 
-    eosio_assert(notif.to == to, "Message not addressed to your account");
+    message_table messages(_self, notif.from.value); // Message stored in sender's scope
+    auto itr_msg = messages.find(notif.msg_id);
+    check(itr_msg != messages.end(), "Message not found");
 
-    message_table messages(_self, notif.from); // Message stored in sender's scope
-    auto itr_msg = messages.find(id);
-    eosio_assert(itr_msg != messages.end(), "Message not found");
-
-    // Remove notification and message
+    // Remove notification and release message
     notifications.erase(itr_notif);
-    messages.erase(itr_msg);
+    release_message(messages, itr_msg);
   }
 
   /**
-   * @brief Delete a message sent by the sender (without recipient reading it).
-   * - Only the sender can call this action.
-   * - The notification and the message are deleted.
-   * @param from  Sender account (must authorize)
-   * @param id    The message/notification id
-   * @abi action
+   * @brief Receive (and delete) up to max messages sent to the recipient.
+   * - Walks the recipient's own inbox scope, oldest notification first.
+   * - Each notification is deleted and its message released.
+   * - Only the recipient can call this action.
+   * @param to   The recipient account (must authorize)
+   * @param max  Maximum number of messages to receive in this call
    */
-  void erasemsg(const account_name from, uint64_t id)
+  [[eosio::action]]
+  void receiveall(const name to, uint64_t max)
   {
-    require_auth(from);
+    require_auth(to);
 
-    notification_table notifications(_self, _self);
-    auto itr_notif = notifications.find(id);
-    eosio_assert(itr_notif != notifications.end(), "Notification not found");
-    const auto &notif = *itr_notif;
+    check(max > 0, "max must be positive");
+
+    notification_table notifications(_self, to.value); // Recipient's inbox
 
-    eosio_assert(notif.from == from, "Message was not sent from your account");
+    uint64_t received = 0;
+    auto itr_notif = notifications.begin();
+    while (received < max && itr_notif != notifications.end())
+    {
+      message_table messages(_self, itr_notif->from.value); // Message stored in sender's scope
+      auto itr_msg = messages.find(itr_notif->msg_id);
+      if (itr_msg != messages.end())
+        release_message(messages, itr_msg);
+
+      // Remove notification, advancing to the next one in the inbox
+      itr_notif = notifications.erase(itr_notif);
+      ++received;
+    }
+  }
+
+  /**
+   * @brief Delete a message sent by the sender for one recipient (without it reading it).
+   * - Only the sender can call this action.
+   * - The recipient's notification is deleted and the message released: a direct
+   *   message is erased, a broadcast body once its last notification is gone.
+   * @param from       Sender account (must authorize)
+   * @param id         The message id in the sender's outbox
+   * @param recipient  The recipient whose notification is dropped
+   */
+  [[eosio::action]]
+  void erasemsg(const name from, uint64_t id, const name recipient)
+  {
+    require_auth(from);
 
-    message_table messages(_self, from); // Message stored in sender's scope
+    message_table messages(_self, from.value); // Message stored in sender's scope
     auto itr_msg = messages.find(id);
-    eosio_assert(itr_msg != messages.end(), "Message not found");
+    check(itr_msg != messages.end(), "Message not found");
+
+    notification_table notifications(_self, recipient.value); // Recipient's inbox
+    auto itr_notif = notifications.end();
+    if (itr_msg->to != BROADCAST)
+    {
+      check(itr_msg->to == recipient, "Message was sent to another recipient");
+      itr_notif = notifications.find(itr_msg->ref);
+    }
+    else
+    {
+      itr_notif = find_notification(notifications, from, id, itr_msg->send_at.sec_since_epoch());
+    }
+    check(itr_notif != notifications.end(), "Notification not found");
 
-    // Remove notification and message
+    // Remove notification and release message
     notifications.erase(itr_notif);
-    messages.erase(itr_msg);
+    release_message(messages, itr_msg);
   }
 
+#ifdef GF_INSTRUMENTATION
+  /**
+   * @brief Instrumentation sink for sendmsg and broadcast.
+   * - Does nothing; indexers read the counters from the action trace.
+   */
+  [[eosio::action]]
+  void log(const gf_instrumentation::counters &event)
+  {
+  }
+
+#endif
 private:
 
+  /**
+   * @brief Cost counters of the running action.
+   * - The helpers below count their table operations here; sendmsg and broadcast
+   *   reset it on entry and emit it at the end, other actions never emit it.
+   */
+  gf_instrumentation::probe _probe{0};
+
+  /**
+   * @struct config_info
+   * @brief Contract configuration (singleton, scope: contract).
+   */
+  struct [[eosio::table("config")]] config_info
+  {
+    uint32_t inline_limit = 64;  // Bodies up to this size are stored on chain
+    uint32_t max_size = 4096;    // Maximum body size
+    bool migrated = false;       // True once no legacy message is left (see migrate)
+    uint64_t id_floor = 0;       // First message id above every legacy id
+
+    EOSLIB_SERIALIZE(config_info, (inline_limit)(max_size)(migrated)(id_floor))
+  };
+  typedef eosio::singleton<"config"_n, config_info> config_table;
+
+  /**
+   * @brief Read the configuration, or the defaults if it was never stored.
+   * - Without a stored config the contract may predate it, so migrated is only
+   *   assumed when the legacy notification table is empty.
+   */
+  config_info get_config()
+  {
+    config_table config(_self, _self.value);
+    _probe.read();
+    if (config.exists())
+      return config.get();
+
+    config_info cfg;
+    legacy_notification_table legacy(_self, _self.value);
+    _probe.read();
+    cfg.migrated = legacy.begin() == legacy.end();
+    return cfg;
+  }
+
+  /**
+   * @struct sequence
+   * @brief Per-account id counter (scope: account, single row).
+   * - Used for message ids in the sender's outbox.
+   */
+  struct [[eosio::table("sequence")]] sequence
+  {
+    uint64_t next_id = 0; // Next id to hand out
+
+    uint64_t primary_key() const { return 0; }
+
+    EOSLIB_SERIALIZE(sequence, (next_id))
+  };
+  typedef eosio::multi_index<"sequence"_n, sequence> sequence_table;
+
+  /**
+   * @brief Allocate the next message id from the sender's sequence.
+   * - The first allocation creates the counter row, paid by the sender,
+   *   starting at the config's id floor so it never reuses a legacy id.
+   */
+  uint64_t next_id(const name account, const config_info &cfg)
+  {
+    sequence_table sequences(_self, account.value);
+    auto itr = sequences.begin();
+    _probe.read();
+    if (itr == sequences.end())
+    {
+      itr = sequences.emplace(account, [&](auto &s) {
+        s.next_id = cfg.id_floor + 1;
+      });
+      _probe.write(*itr);
+      return cfg.id_floor;
+    }
+
+    const uint64_t id = itr->next_id;
+    sequences.modify(itr, same_payer, [&](auto &s) {
+      s.next_id = id + 1;
+    });
+    _probe.write(*itr);
+    return id;
+  }
+
+  /**
+   * @brief Add a notification to the recipient's inbox, returns its id.
+   * - The id is the send time in the high 32 bits and a hash of (from, msg_id) in
+   *   the low 32 bits, so the inbox stays ordered oldest first. On the rare
+   *   collision the next free id is taken.
+   */
+  uint64_t store_notification(const name from, const uint64_t msg_id,
+                              const name to, const uint32_t send_at, const name payer)
+  {
+    notification_table notifications(_self, to.value);
+    uint64_t notif_id = notification_id(from, msg_id, send_at);
+    _probe.read();
+    while (notifications.find(notif_id) != notifications.end())
+    {
+      ++notif_id;
+      _probe.read();
+    }
+
+    auto itr = notifications.emplace(payer, [&](auto &n) {
+      n.id = notif_id;
+      n.from = from;
+      n.msg_id = msg_id;
+    });
+    _probe.write(*itr);
+    return notif_id;
+  }
+
+  /**
+   * @brief First id tried for the notification of (from, msg_id) sent at send_at.
+   */
+  static uint64_t notification_id(const name from, const uint64_t msg_id, const uint32_t send_at)
+  {
+    uint64_t h = from.value ^ (msg_id * 0x9e3779b97f4a7c15ULL);
+    h = (h ^ (h >> 33)) * 0xff51afd7ed558ccdULL;
+    h = h ^ (h >> 33);
+    return (uint64_t(send_at) << 32) | (h & 0xffffffffULL);
+  }
+
+  /**
+   * @brief Store a message in the sender's outbox (paid by sender).
+   * - Checks body size against the config and picks inline or hashed storage.
+   * @param ref   Notification id (direct message) or number of recipients (broadcast)
+   */
+  void store_message(const config_info &cfg,
+                     const name from, const uint64_t msg_id,
+                     const name to, const uint64_t ref,
+                     const std::string &msg)
+  {
+    check(msg.size() > 0, "Empty message");
+    check(msg.size() <= cfg.max_size, "Message is too long");
+    const bool is_inline = msg.size() <= cfg.inline_limit;
+
+    message_table messages(_self, from.value);
+    auto itr = messages.emplace(from, [&](auto &m) {
+      m.id = msg_id;
+      m.to = to;
+      if (is_inline)
+        m.body = msg;
+      else
+        m.body = sha256(msg.data(), msg.size());
+      m.send_at = eosio::time_point_sec(current_time_point());
+      m.ref = ref;
+    });
+
+    _probe.write(*itr);
+  }
+
   /**
    * @struct message
    * @brief Table structure for messages sent from this user.
    * - Scoped by sender's account.
-   * - Stores recipient, message text, send time, and type.
-   * @abi table message i64
+   * - Stores recipient, message text (or its hash) and send time.
+   * - The body holds either the text or, for bodies over the inline limit, its sha256;
+   *   the variant index tells which, so only one of them takes space in the row.
+   * - ref holds whichever reference the message kind needs: the recipient's
+   *   notification id for a direct message, the count of pending recipients for a broadcast.
    */
-  struct message
+  struct [[eosio::table("message")]] message
   {
-    uint64_t id;                   // Unique message id
-    account_name to;               // Recipient account
-    std::string text;              // Message body
+    uint64_t id;                   // Message id (unique in sender's outbox)
+    name to;                       // Recipient account (BROADCAST for broadcast messages)
+    std::variant<std::string, checksum256> body; // Message text, or sha256 of the text
     eosio::time_point_sec send_at; // Timestamp of when sent
-    uint8_t type;                  // Reserved for future message types
+    uint64_t ref;                  // Notification id (direct) or notifications still referencing it (broadcast)
 
     uint64_t primary_key() const { return id; }
 
-    EOSLIB_SERIALIZE(message, (id)(to)(text)(send_at)(type))
+    EOSLIB_SERIALIZE(message, (id)(to)(body)(send_at)(ref))
   };
-  typedef eosio::multi_index<N(message), message> message_table;
+  typedef eosio::multi_index<"message"_n, message> message_table;
 
   /**
    * @struct notification
    * @brief Table structure for notifications of new messages.
-   * - Stored globally (scope: contract).
-   * - Each notification has sender and recipient accounts.
-   * @abi table notification i64
+   * - Scoped by recipient's account (the recipient's inbox).
+   * - Each notification points to the message in the sender's outbox.
+   */
+  struct [[eosio::table("notification")]] notification
+  {
+    uint64_t id;           // Notification id (unique in recipient's inbox)
+    name from;             // Sender account
+    uint64_t msg_id;       // Message id in sender's outbox
+
+    uint64_t primary_key() const { return id; }
+
+    EOSLIB_SERIALIZE(notification, (id)(from)(msg_id))
+  };
+  typedef eosio::multi_index<"notification"_n, notification> notification_table;
+
+  /**
+   * @struct legacy_notification
+   * @brief Notification of the single-table layout (scope: contract), read only by migrate.
+   * - Shares the notification table name, so it is not part of the ABI.
+   */
+  struct legacy_notification
+  {
+    uint64_t id;           // Message id (from the old global counter)
+    name from;             // Sender account
+    name to;               // Recipient account
+
+    uint64_t primary_key() const { return id; }
+    uint64_t get_to_key() const { return to.value; }
+
+    EOSLIB_SERIALIZE(legacy_notification, (id)(from)(to))
+  };
+  typedef eosio::multi_index<"notification"_n, legacy_notification,
+                             eosio::indexed_by<"to"_n,
+                                               eosio::const_mem_fun<legacy_notification, uint64_t,
+                                                                    &legacy_notification::get_to_key>>>
+      legacy_notification_table;
+
+  /**
+   * @struct legacy_message
+   * @brief Message of the single-table layout (scope: sender), read only by migrate.
    */
-  struct notification
+  struct legacy_message
   {
-    uint64_t id;           // Unique notification id (matches message id)
-    account_name from;     // Sender account
-    account_name to;       // Recipient account
+    uint64_t id;                   // Message id (from the old global counter)
+    name to;                       // Recipient account
+    std::string text;              // Message body
+    eosio::time_point_sec send_at; // Timestamp of when sent
+    uint8_t type;                  // Unused
 
     uint64_t primary_key() const { return id; }
-     account_name get_to_key() const { return to; }
-    
-    EOSLIB_SERIALIZE(notification, (id)(from)(to))
+
+    EOSLIB_SERIALIZE(legacy_message, (id)(to)(text)(send_at)(type))
   };
+  typedef eosio::multi_index<"message"_n, legacy_message> legacy_message_table;
+
+  /**
+   * @brief Find the notification of (from, msg_id) in an inbox, or end().
+   * - It was stored at the first free id from notification_id on, and notifications
+   *   received since may have left gaps, so the inbox is walked from that id on to the
+   *   end of the next second (the furthest a collision can push it in practice).
+   */
+  notification_table::const_iterator find_notification(notification_table &notifications,
+                                                       const name from, const uint64_t msg_id,
+                                                       const uint32_t send_at)
+  {
+    const uint64_t last = (uint64_t(send_at) + 2) << 32;
+    auto itr = notifications.lower_bound(notification_id(from, msg_id, send_at));
+    while (itr != notifications.end() && itr->id < last)
+    {
+      if (itr->from == from && itr->msg_id == msg_id)
+        return itr;
+      ++itr;
+    }
+    return notifications.end();
+  }
 
-  typedef eosio::multi_index<N(notification), notification,
-                             eosio::indexed_by<N(to),
-                                               eosio::const_mem_fun<
-                                                   notification,
-                                                   account_name,
-                                                   &notification::get_to_key>>>
-      notification_table;
+  /**
+   * @brief Drop one reference to a message, erasing it with the last one.
+   * - A direct message has a single reference, its notification.
+   */
+  template <typename Iterator>
+  void release_message(message_table &messages, Iterator itr)
+  {
+    if (itr->to != BROADCAST || itr->ref <= 1)
+    {
+      messages.erase(itr);
+      return;
+    }
+
+    messages.modify(itr, same_payer, [&](auto &m) {
+      m.ref--;
+    });
+  }
 
 };
 
-EOSIO_ABI(messenger, (sendmsg)(receivemsg)(erasemsg))
\ No newline at end of file
+#ifdef GF_INSTRUMENTATION
+EOSIO_DISPATCH(messenger, (setconfig)(migrate)(sendmsg)(broadcast)(receivemsg)(receiveall)(erasemsg)(log))
+#else
+EOSIO_DISPATCH(messenger, (setconfig)(migrate)(sendmsg)(broadcast)(receivemsg)(receiveall)(erasemsg))
+#endif
\ No newline at end of file
@@ -1,4 +1,7 @@
 #include <eosio/eosio.hpp>
+#include "content_store.hpp"
+#include <utility>
+#include <vector>
 using namespace eosio;
 
 CONTRACT mycontract : public contract {
@@ -7,7 +10,8 @@ CONTRACT mycontract : public contract {
 
     TABLE StoredData {
       uint64_t id;
-      std::string text;
+      std::string text;                         // Inline text (short records only)
+      std::optional<checksum256> text_ref;      // Hash of deduplicated text in content_store::bodies
       
       uint64_t primary_key() const { return id; }
     };
@@ -18,7 +22,38 @@ CONTRACT mycontract : public contract {
       storage_table _storage( get_self(), get_self().value );
       _storage.emplace( get_self(), [&]( auto& row ) {
         row.id = id;
-        row.text = text;
+        content_store::assign( get_self(), get_self(), text, row.text, row.text_ref );
       });
     }
+
+    // Insert the record, or replace its text if the id exists
+    ACTION upsert( uint64_t id, std::string text ) {
+      require_auth( get_self() );
+      storage_table _storage( get_self(), get_self().value );
+      put( _storage, id, text );
+    }
+
+    // Upsert many records with one table instance
+    ACTION savebatch( std::vector<std::pair<uint64_t, std::string>> records ) {
+      require_auth( get_self() );
+      storage_table _storage( get_self(), get_self().value );
+      for( const auto& record : records ) {
+        put( _storage, record.first, record.second );
+      }
+    }
+
+  private:
+    void put( storage_table& _storage, uint64_t id, const std::string& text ) {
+      auto itr = _storage.find( id );
+      if( itr == _storage.end() ) {
+        _storage.emplace( get_self(), [&]( auto& row ) {
+          row.id = id;
+          content_store::assign( get_self(), get_self(), text, row.text, row.text_ref );
+        });
+      } else {
+        _storage.modify( itr, same_payer, [&]( auto& row ) {
+          content_store::assign( get_self(), get_self(), text, row.text, row.text_ref );
+        });
+      }
+    }
 };
@@ -11,52 +11,86 @@
 
 /**
  * @brief Sets up a poll object with the specified options and properties.
+ *        Option names are validated in place and appended to one packed buffer,
+ *        so no per-option string is copied or stored.
  * @param id            The poll's unique ID.
  * @param question      The poll question.
  * @param options       The list of options for voting.
- * @param is_token_poll True if this is a token-weighted poll.
- * @param token         Information about the token for weighting, if needed.
+ * @param owner         The poll creator.
  */
 void pollgf::poll::set(pollgf::poll_id_t id, const std::string& question,
-                        const option_names_t& options, bool is_token_poll,
-                        token_info_t token) {
+                        const option_names_t& options, eosio::name owner) {
 
-   eosio_assert(!question.empty(), "Question can't be empty");
+   eosio::check(!question.empty(), "Question can't be empty");
 
    this->id            = id;
    this->question      = question;
-   this->is_token_poll = is_token_poll;
-   this->token         = token;
+   this->owner         = owner;
 
-   // Prepare results array for each voting option.
-   results.resize(options.size());
-   std::transform(options.begin(), options.end(), results.begin(),
-                  [&](std::string str) {
-                     eosio_assert(!str.empty(), "Option names can't be empty");
-                     return option_result(str);
-                  });
+   // Validate names and size the packed buffer in one pass.
+   size_t packed_size = options.empty() ? 0 : options.size() - 1;
+   for (const auto& name : options) {
+      eosio::check(!name.empty(), "Option names can't be empty");
+      eosio::check(name.size() <= max_option_size, "Option name is too long");
+      eosio::check(name.find(option_separator) == std::string::npos,
+                   "Option names can't contain a line break");
+      packed_size += name.size();
+   }
+
+   this->options.clear();
+   this->options.reserve(packed_size);
+   for (size_t i = 0; i < options.size(); ++i) {
+      if (i > 0)
+         this->options += option_separator;
+      this->options += options[i];
+   }
 }
 
 /**
- * @brief Stores a new poll in the contract's poll table.
+ * @brief Stores a new poll in the contract's poll table,
+ *        together with its compact listing row and, for token-weighted
+ *        kinds, its token settings row.
  * @param question      The poll question.
  * @param poll_owner    Who pays RAM for this poll (creator).
  * @param options       The list of voting options.
- * @param is_token_poll Whether the poll is token-weighted.
- * @param token         Token info, if needed.
+ * @param kind          POLL_PLAIN, POLL_TOKEN or POLL_SNAPSHOT.
+ * @param token         Token info (ignored for plain polls).
+ * @param duration      Seconds from now until voting closes.
  */
-void pollgf::store_poll(const std::string& question, account_name poll_owner,
-                         const option_names_t& options,
-                         bool is_token_poll, token_info_t token) {
+void pollgf::store_poll(const std::string& question, eosio::name poll_owner,
+                         const option_names_t& options, uint8_t kind,
+                         token_info_t token, uint32_t duration) {
 
    poll_id_t  id;
 
-   eosio_assert(options.size() < std::numeric_limits<option_id_t>::max(),
+   eosio::check(options.size() < std::numeric_limits<option_id_t>::max(),
                 "Too many options");
+   eosio::check(duration > 0, "Poll duration must be positive");
+   eosio::check(duration <= max_duration, "Poll duration is too long");
 
+   // Legacy poll rows may still share the table, so the next id is taken from the
+   // leading ids only; unpacking a legacy row as a poll would fail
+   poll_key_table keys(get_self(), get_self().value);
+   id = keys.available_primary_key();
    _polls.emplace(poll_owner, [&](poll& p) {
-      id = _polls.available_primary_key();
-      p.set(id, question, options, is_token_poll, token);
+      p.set(id, question, options, poll_owner);
+   });
+
+   if (kind != POLL_PLAIN) {
+      token_poll_table tokens(get_self(), get_self().value);
+      tokens.emplace(poll_owner, [&](token_poll& t) {
+         t.id    = id;
+         t.token = token;
+      });
+   }
+
+   summary_table summaries(get_self(), get_self().value);
+   summaries.emplace(poll_owner, [&](poll_summary& s) {
+      s.id           = id;
+      s.question_hash = eosio::sha256(question.data(), question.size());
+      s.option_count = options.size();
+      s.closes_at    = eosio::current_time_point().sec_since_epoch() + duration;
+      s.kind         = kind;
    });
 
    eosio::print("Poll stored with id: ", id);
@@ -64,50 +98,120 @@ void pollgf::store_poll(const std::string& question, account_name poll_owner,
 
 /**
  * @brief Stores a user's vote in a poll (with explicit vote weight).
- *        Also increments the selected option's result.
- * @param p         The poll object.
- * @param votes     The vote table for the voter.
+ *        Also increments the selected option's tally row.
+ *        The tally row is created by the first voter for that option.
+ * @param id        The poll id.
+ * @param votes     The vote table of the poll.
+ * @param voter     The voter's account.
  * @param option_id The selected option's ID.
- * @param weight    The weight of the vote (1 for normal, token balance for token polls).
+ * @param weight    The weight of the vote (1 for normal, token balance in base units for token polls).
  */
-void pollgf::store_vote(const pollgf::poll& p, pollgf::vote_table& votes,
-                         option_id_t option_id, double weight) {
+void pollgf::store_vote(pollgf::poll_id_t id, pollgf::vote_table& votes, eosio::name voter,
+                         option_id_t option_id, uint64_t weight) {
 
-   eosio_assert(weight > 0, "Vote weight cannot be less than 0. Contract logic issue");
+   eosio::check(weight > 0, "Vote weight cannot be less than 0. Contract logic issue");
 
-   // Voter (votes.get_scope()) pays for RAM.
-   votes.emplace(votes.get_scope(), [&](poll_vote& v) {
-      v.poll_id    = p.id;
+   // Voter pays for RAM.
+   auto vitr = votes.emplace(voter, [&](poll_vote& v) {
+      v.voter      = voter;
       v.option_id  = option_id;
    });
+   _probe.write(*vitr);
 
-   _polls.modify(p, votes.get_scope(), [&](poll& p) {
-      p.results[option_id].votes += weight;
-   });
+   tally_table tallies(get_self(), id);
+   auto itr = tallies.find(option_id);
+   _probe.read();
+   if (itr == tallies.end()) {
+      itr = tallies.emplace(voter, [&](option_tally& t) {
+         t.option_id = option_id;
+         t.votes     = weight;
+      });
+   } else {
+      eosio::check(itr->votes + weight > itr->votes, "Vote tally overflow");
+      tallies.modify(itr, eosio::same_payer, [&](option_tally& t) {
+         t.votes += weight;
+      });
+   }
+   _probe.write(*itr);
 }
 
 /**
- * @brief Stores a user's token-weighted vote in a poll.
- *        Checks token balance, then records vote.
- * @param p         The poll object.
- * @param votes     The vote table for the voter.
- * @param option_id The selected option's ID.
+ * @brief Vote weight in a token-weighted poll: the voter's current token balance.
+ *        An account without a balance row has no weight; callers decide whether
+ *        zero is enough (a proxy may vote with delegated weight only).
+ * @param id     The poll id.
+ * @param voter  The voter's account.
  */
-void pollgf::store_token_vote(const pollgf::poll& p, pollgf::vote_table& votes,
-                               option_id_t option_id) {
+uint64_t pollgf::vote_weight(pollgf::token_kind, pollgf::poll_id_t id, eosio::name voter) {
 
-   account_name voter = votes.get_scope();
+   token_poll_table tokens(get_self(), get_self().value);
+   const token_poll& t = tokens.get(id, "Token settings of this poll do not exist");
+   _probe.read();
 
-   eosio::token token(p.token.contract);
-   // Will fail if voter has no tokens
-   eosio::asset balance = token.get_balance(voter, p.token.name());
+   const eosio::symbol_code sym = t.token.get_symbol().code();
+   token_account_table accounts(t.token.get_contract(), voter.value);
+   auto itr = accounts.find(sym.raw());
+   _probe.read();
+   if (itr == accounts.end())
+      return 0;
 
    // Validate token balance
-   eosio_assert(balance.is_valid(), "Balance of voter account is invalid. Something is wrong with token contract.");
-   eosio_assert(balance.amount > 0, "Voter must have more than 0 tokens to participate in a poll!");
+   eosio::check(itr->balance.is_valid(), "Balance of voter account is invalid. Something is wrong with token contract.");
+   eosio::check(itr->balance.amount >= 0, "Balance of voter account is negative. Something is wrong with token contract.");
+
+   return static_cast<uint64_t>(itr->balance.amount);
+}
+
+/**
+ * @brief Vote weight in a snapshot poll.
+ *        The weight is looked up in the imported snapshot, so no token
+ *        contract is queried and moving tokens after creation has no effect.
+ *        An account missing from the snapshot has no weight.
+ * @param id     The poll id.
+ * @param voter  The voter's account.
+ */
+uint64_t pollgf::vote_weight(pollgf::snapshot_kind, pollgf::poll_id_t id, eosio::name voter) {
+
+   token_poll_table tokens(get_self(), get_self().value);
+   const token_poll& t = tokens.get(id, "Token settings of this poll do not exist");
+   _probe.read();
+   eosio::check(t.is_sealed, "Snapshot of this poll is not sealed yet");
+
+   weight_table weights(get_self(), id);
+   auto itr = weights.find(voter.value);
+   _probe.read();
+   if (itr == weights.end())
+      return 0;
 
-   // Store vote with token balance as weight
-   store_vote(p, votes, option_id, to_weight(balance));
+   return static_cast<uint64_t>(itr->amount);
+}
+
+/**
+ * @brief Asserts that a token exists, reading the supply table of its contract.
+ * @param token  Token info (symbol+contract).
+ */
+void pollgf::check_token_exists(pollgf::token_info_t token) {
+
+   const eosio::symbol_code sym = token.get_symbol().code();
+   token_stats_table stats(token.get_contract(), sym.raw());
+   eosio::check(stats.find(sym.raw()) != stats.end(), "This token does not exist");
+}
+
+/**
+ * @brief Returns the token settings of a snapshot poll whose snapshot can still be loaded.
+ * @param tokens  The token poll table.
+ * @param id      The poll id.
+ */
+const pollgf::token_poll& pollgf::get_unsealed_snapshot(pollgf::token_poll_table& tokens,
+                                                        pollgf::poll_id_t id) {
+
+   summary_table summaries(get_self(), get_self().value);
+   const poll_summary & s = summaries.get(id, "Poll with this id does not exist");
+   eosio::check(s.kind == POLL_SNAPSHOT, "Poll does not use a snapshot");
+
+   const token_poll& t = tokens.get(id, "Token settings of this poll do not exist");
+   eosio::check(!t.is_sealed, "Snapshot of this poll is already sealed");
+   return t;
 }
 
 /**
@@ -115,12 +219,13 @@ void pollgf::store_token_vote(const pollgf::poll& p, pollgf::vote_table& votes,
  * @param question The poll question.
  * @param payer    Account paying for RAM.
  * @param options  The list of voting options.
+ * @param duration Seconds until voting closes.
  * @abi action
  */
-void pollgf::newpoll(const std::string& question, account_name payer,
-                      const option_names_t& options) {
+void pollgf::newpoll(const std::string& question, eosio::name payer,
+                      const option_names_t& options, uint32_t duration) {
 
-   store_poll(question, payer, options, false, token_info_t());
+   store_poll(question, payer, options, POLL_PLAIN, token_info_t(), duration);
 }
 
 /**
@@ -129,42 +234,640 @@ void pollgf::newpoll(const std::string& question, account_name payer,
  * @param owner      Account paying for RAM.
  * @param options    The list of voting options.
  * @param token_inf  Info about the token to use for vote weighting.
+ * @param duration   Seconds until voting closes.
+ * @abi action
+ */
+void pollgf::newtokenpoll(const std::string& question, eosio::name owner,
+                           const option_names_t& options, token_info_t token_inf,
+                           uint32_t duration) {
+
+   check_token_exists(token_inf);
+   store_poll(question, owner, options, POLL_TOKEN, token_inf, duration);
+}
+
+/**
+ * @brief Create a new token-weighted poll that uses a balance snapshot.
+ *        The owner imports the snapshot with loadweights and opens
+ *        voting with sealpoll.
+ * @param question   The poll question.
+ * @param owner      Poll owner, pays for RAM.
+ * @param options    The list of voting options.
+ * @param token_inf  Info about the token the snapshot was taken of.
+ * @param duration   Seconds until voting closes.
  * @abi action
  */
-void pollgf::newtokenpoll(const std::string& question, account_name owner,
-                           const option_names_t& options, token_info_t token_inf) {
+void pollgf::newsnappoll(const std::string& question, eosio::name owner,
+                          const option_names_t& options, token_info_t token_inf,
+                          uint32_t duration) {
+
+   eosio::require_auth(owner);
+
+   check_token_exists(token_inf);
+   store_poll(question, owner, options, POLL_SNAPSHOT, token_inf, duration);
+}
+
+/**
+ * @brief Import (part of) the balance snapshot of a snapshot poll.
+ *        May be called repeatedly until the poll is sealed.
+ *        Existing entries for a voter are overwritten.
+ * @param id       Poll id.
+ * @param weights  Voter balances in token base units.
+ * @abi action
+ */
+void pollgf::loadweights(pollgf::poll_id_t id, const std::vector<voter_weight>& weights) {
+
+   const poll & p = _polls.get(id, "Poll with this id does not exist");
+   eosio::require_auth(p.owner);
+
+   token_poll_table tokens(get_self(), get_self().value);
+   get_unsealed_snapshot(tokens, id);
+
+   weight_table table(get_self(), p.id);
+   for (const auto& w : weights) {
+      eosio::check(w.amount >= 0, "Snapshot balance cannot be negative");
+
+      auto itr = table.find(w.voter.value);
+      if (itr == table.end()) {
+         table.emplace(p.owner, [&](voter_weight& row) {
+            row = w;
+         });
+      } else {
+         table.modify(itr, eosio::same_payer, [&](voter_weight& row) {
+            row.amount = w.amount;
+         });
+      }
+   }
+}
+
+/**
+ * @brief Seal the snapshot of a snapshot poll and open it for voting.
+ * @param id  Poll id.
+ * @abi action
+ */
+void pollgf::sealpoll(pollgf::poll_id_t id) {
+
+   const poll & p = _polls.get(id, "Poll with this id does not exist");
+   eosio::require_auth(p.owner);
+
+   token_poll_table tokens(get_self(), get_self().value);
+   const token_poll& t = get_unsealed_snapshot(tokens, id);
 
-   eosio::token token(token_inf.contract);
-   eosio_assert(token.exists(token_inf.name()), "This token does not exist");
-   store_poll(question, owner, options, true, token_inf);
+   tokens.modify(t, eosio::same_payer, [&](token_poll& row) {
+      row.is_sealed = true;
+   });
 }
 
 /**
  * @brief Cast a vote in a poll.
  *        Checks for double-voting and option validity, then stores the vote.
+ *        A proxy first takes over the weight of up to standing_batch of its standing
+ *        delegators (see setproxy; collect takes the rest) and may vote without
+ *        weight of its own if weight was delegated to it.
  * @param id        Poll id.
  * @param voter     Voter's account.
  * @param option_id Chosen option's index.
  * @abi action
  */
-void pollgf::vote(pollgf::poll_id_t id, account_name voter, option_id_t option_id) {
+void pollgf::vote(pollgf::poll_id_t id, eosio::name voter, option_id_t option_id) {
+
+   eosio::require_auth(voter);
+   _probe = gf_instrumentation::probe("vote"_n.value);
+
+   summary_table summaries(get_self(), get_self().value);
+   const poll_summary & s = summaries.get(id, "Poll with this id does not exist");
+   _probe.read();
+   eosio::check(s.is_open(), "Poll is closed");
+
+   // The summary row has everything the vote needs, the poll row is not read
+   eosio::check(option_id < s.option_count, "Option with this id does not exist");
+
+   vote_table votes(get_self(), id);
+   _probe.read();
+   eosio::check(votes.find(voter.value) == votes.end(), "This account has already voted in this poll");
+
+   delegation_table delegations(get_self(), id);
+   _probe.read();
+   eosio::check(delegations.find(voter.value) == delegations.end(), "This account delegated its vote in this poll");
+
+   switch (s.kind) {
+      case POLL_SNAPSHOT:
+         cast_vote<snapshot_kind>(id, votes, voter, option_id);
+         break;
+      case POLL_TOKEN:
+         cast_vote<token_kind>(id, votes, voter, option_id);
+         break;
+      default:
+         cast_vote<plain_kind>(id, votes, voter, option_id);
+   }
+
+   _probe.emit(get_self(), "log"_n);
+}
+
+/**
+ * @brief Delegate a vote in a poll to a proxy.
+ *        The voter's weight is added to the proxy's delegated weight and, if the
+ *        proxy has already voted, straight to the tally of its option, so the
+ *        delegation counts without any further action. Proxies can't delegate
+ *        themselves, which keeps every change a single step. A voter that already
+ *        delegated moves the delegation to the new proxy.
+ * @param id     Poll id.
+ * @param voter  Delegating account.
+ * @param proxy  Account voting on the voter's behalf.
+ * @abi action
+ */
+void pollgf::delegate(pollgf::poll_id_t id, eosio::name voter, eosio::name proxy) {
+
+   eosio::require_auth(voter);
+   eosio::check(voter != proxy, "Cannot delegate to self");
+   eosio::check(eosio::is_account(proxy), "Proxy account does not exist");
+
+   summary_table summaries(get_self(), get_self().value);
+   const poll_summary & s = summaries.get(id, "Poll with this id does not exist");
+   eosio::check(s.is_open(), "Poll is closed");
+
+   vote_table votes(get_self(), id);
+   eosio::check(votes.find(voter.value) == votes.end(), "This account has already voted in this poll");
+
+   delegation_table delegations(get_self(), id);
+   eosio::check(delegations.find(proxy.value) == delegations.end(), "Proxy delegated its own vote in this poll");
+   eosio::check(delegated_weight(id, voter) == 0, "Proxies can't delegate their vote");
+
+   auto itr = delegations.find(voter.value);
+   if (itr != delegations.end()) {
+      eosio::check(itr->proxy != proxy, "Vote is already delegated to this proxy");
+      undelegate(id, voter);
+   }
+
+   switch (s.kind) {
+      case POLL_SNAPSHOT:
+         cast_delegation<snapshot_kind>(id, voter, proxy);
+         break;
+      case POLL_TOKEN:
+         cast_delegation<token_kind>(id, voter, proxy);
+         break;
+      default:
+         cast_delegation<plain_kind>(id, voter, proxy);
+   }
+}
+
+/**
+ * @brief Withdraw a delegation while the poll is open.
+ *        The weight is taken back from the proxy and, if it voted, from its option.
+ *        The voter may then vote directly or delegate again.
+ * @param id     Poll id.
+ * @param voter  Delegating account.
+ * @abi action
+ */
+void pollgf::undelegate(pollgf::poll_id_t id, eosio::name voter) {
+
+   eosio::require_auth(voter);
+
+   summary_table summaries(get_self(), get_self().value);
+   const poll_summary & s = summaries.get(id, "Poll with this id does not exist");
+   eosio::check(s.is_open(), "Poll is closed");
+
+   delegation_table delegations(get_self(), id);
+   const delegation & d = delegations.get(voter.value, "This account has not delegated its vote in this poll");
+
+   proxy_table proxies(get_self(), id);
+   const proxy_weight & pw = proxies.get(d.proxy.value, "Proxy weight not found. Contract logic issue");
+   if (pw.delegated <= d.weight) {
+      proxies.erase(pw);
+   } else {
+      proxies.modify(pw, eosio::same_payer, [&](proxy_weight& row) {
+         row.delegated -= d.weight;
+      });
+   }
+
+   adjust_proxy_tally(id, d.proxy, d.weight, true);
+   delegations.erase(d);
+}
+
+/**
+ * @brief Stores a delegation.
+ *        Touches one delegation row, one proxy row and at most one tally row.
+ * @param id      Poll id.
+ * @param voter   Delegating account.
+ * @param proxy   Proxy account.
+ * @param weight  The voter's weight.
+ * @param payer   Pays for the rows: the voter, or the proxy for a standing delegation.
+ */
+void pollgf::store_delegation(pollgf::poll_id_t id, eosio::name voter, eosio::name proxy,
+                               uint64_t weight, eosio::name payer) {
+
+   eosio::check(weight > 0, "Vote weight cannot be less than 0. Contract logic issue");
+
+   delegation_table delegations(get_self(), id);
+   auto ditr = delegations.emplace(payer, [&](delegation& d) {
+      d.voter  = voter;
+      d.proxy  = proxy;
+      d.weight = weight;
+   });
+   _probe.write(*ditr);
+
+   proxy_table proxies(get_self(), id);
+   auto itr = proxies.find(proxy.value);
+   _probe.read();
+   if (itr == proxies.end()) {
+      itr = proxies.emplace(payer, [&](proxy_weight& pw) {
+         pw.proxy     = proxy;
+         pw.delegated = weight;
+      });
+   } else {
+      eosio::check(itr->delegated + weight > itr->delegated, "Delegated weight overflow");
+      proxies.modify(itr, eosio::same_payer, [&](proxy_weight& pw) {
+         pw.delegated += weight;
+      });
+   }
+   _probe.write(*itr);
+
+   adjust_proxy_tally(id, proxy, weight, false);
+}
+
+/**
+ * @brief True if voter voted, delegated its vote or has delegators in a poll.
+ * @param id           Poll id.
+ * @param votes        The vote table of the poll.
+ * @param delegations  The delegation table of the poll.
+ * @param voter        Account to check.
+ */
+bool pollgf::takes_part(pollgf::poll_id_t id, pollgf::vote_table& votes,
+                        pollgf::delegation_table& delegations, eosio::name voter) {
+
+   _probe.read();
+   if (votes.find(voter.value) != votes.end())
+      return true;
+
+   _probe.read();
+   if (delegations.find(voter.value) != delegations.end())
+      return true;
+
+   return delegated_weight(id, voter) > 0;
+}
+
+/**
+ * @brief Sum of the weights delegated to proxy in a poll (0 if none).
+ * @param id     Poll id.
+ * @param proxy  Proxy account.
+ */
+uint64_t pollgf::delegated_weight(pollgf::poll_id_t id, eosio::name proxy) {
+
+   proxy_table proxies(get_self(), id);
+   auto itr = proxies.find(proxy.value);
+   _probe.read();
+   return itr == proxies.end() ? 0 : itr->delegated;
+}
+
+/**
+ * @brief Moves delegated weight in or out of the tally of the option a proxy voted for.
+ *        The tally row exists, since the proxy's own vote created or updated it.
+ * @param id        Poll id.
+ * @param proxy     Proxy account.
+ * @param weight    Delegated weight.
+ * @param subtract  True to remove the weight, false to add it.
+ */
+void pollgf::adjust_proxy_tally(pollgf::poll_id_t id, eosio::name proxy, uint64_t weight,
+                                 bool subtract) {
+
+   vote_table votes(get_self(), id);
+   auto vitr = votes.find(proxy.value);
+   _probe.read();
+   if (vitr == votes.end())
+      return;
+
+   tally_table tallies(get_self(), id);
+   const option_tally & t = tallies.get(vitr->option_id, "Tally not found. Contract logic issue");
+   _probe.read();
+   if (subtract) {
+      eosio::check(t.votes >= weight, "Vote tally underflow");
+   } else {
+      eosio::check(t.votes + weight > t.votes, "Vote tally overflow");
+   }
+   tallies.modify(t, eosio::same_payer, [&](option_tally& row) {
+      row.votes = subtract ? row.votes - weight : row.votes + weight;
+   });
+   _probe.write(t);
+}
+
+/**
+ * @brief Accept standing delegators, or change how many are accepted.
+ *        The proxy pays for the delegation rows of its standing delegators in
+ *        every poll it votes in, so nobody becomes a proxy without opting in.
+ *        A capacity below the current number of delegators keeps them but
+ *        accepts no new ones; 0 stops accepting, and the row goes with the
+ *        last delegator. Standing delegations don't chain: an account with a
+ *        standing proxy can't accept delegators.
+ * @param proxy     Proxy account.
+ * @param capacity  Most standing delegators accepted.
+ * @abi action
+ */
+void pollgf::regproxy(eosio::name proxy, uint32_t capacity) {
+
+   eosio::require_auth(proxy);
+
+   standing_proxy_table standing(get_self(), get_self().value);
+   eosio::check(standing.find(proxy.value) == standing.end(), "Proxy delegated its own vote");
+
+   proxy_info_table proxies(get_self(), get_self().value);
+   auto itr = proxies.find(proxy.value);
+   if (itr == proxies.end()) {
+      eosio::check(capacity > 0, "This account does not accept standing delegators");
+      proxies.emplace(proxy, [&](proxy_info& row) {
+         row.proxy    = proxy;
+         row.capacity = capacity;
+      });
+   } else if (capacity == 0 && itr->delegators == 0) {
+      proxies.erase(itr);
+   } else {
+      proxies.modify(itr, eosio::same_payer, [&](proxy_info& row) {
+         row.capacity = capacity;
+      });
+   }
+}
+
+/**
+ * @brief Delegate the voter's vote in every poll to a proxy, until cleared.
+ *        The proxy must accept standing delegators (see regproxy). Nothing is
+ *        written per poll: when the proxy votes or collects, the voter's weight is
+ *        delegated to it in that poll, unless the voter already voted or delegated
+ *        there (the proxy pays for that delegation row). Once that has happened, the
+ *        voter withdraws from the poll with undelegate.
+ * @param voter  Delegating account.
+ * @param proxy  Account voting on the voter's behalf.
+ * @abi action
+ */
+void pollgf::setproxy(eosio::name voter, eosio::name proxy) {
 
    eosio::require_auth(voter);
+   eosio::check(voter != proxy, "Cannot delegate to self");
+
+   proxy_info_table proxies(get_self(), get_self().value);
+   eosio::check(proxies.find(voter.value) == proxies.end(), "Proxies can't delegate their vote");
+   const proxy_info & info = proxies.get(proxy.value, "Proxy does not accept standing delegators");
+   eosio::check(info.delegators < info.capacity, "Proxy has too many standing delegators");
+
+   standing_proxy_table standing(get_self(), get_self().value);
+   auto itr = standing.find(voter.value);
+   if (itr == standing.end()) {
+      standing.emplace(voter, [&](standing_proxy& row) {
+         row.voter = voter;
+         row.proxy = proxy;
+      });
+   } else {
+      eosio::check(itr->proxy != proxy, "Vote is already delegated to this proxy");
+      release_delegator(proxies, itr->proxy);
+      standing.modify(itr, eosio::same_payer, [&](standing_proxy& row) {
+         row.proxy = proxy;
+      });
+   }
+
+   proxies.modify(info, eosio::same_payer, [&](proxy_info& row) {
+      ++row.delegators;
+   });
+}
+
+/**
+ * @brief Remove the voter's standing delegation.
+ *        Delegations already made in polls where the proxy voted are kept;
+ *        undelegate withdraws them one poll at a time.
+ * @param voter  Delegating account.
+ * @abi action
+ */
+void pollgf::clearproxy(eosio::name voter) {
+
+   eosio::require_auth(voter);
+
+   standing_proxy_table standing(get_self(), get_self().value);
+   const standing_proxy & row = standing.get(voter.value, "This account has no standing proxy");
+
+   proxy_info_table proxies(get_self(), get_self().value);
+   release_delegator(proxies, row.proxy);
+   standing.erase(row);
+}
+
+/**
+ * @brief Count one standing delegator less for proxy.
+ *        The row is erased with the last delegator of a proxy with capacity 0.
+ * @param proxies  The proxy info table.
+ * @param proxy    Proxy account.
+ */
+void pollgf::release_delegator(pollgf::proxy_info_table& proxies, eosio::name proxy) {
+
+   const proxy_info & info = proxies.get(proxy.value, "Proxy info not found. Contract logic issue");
+   if (info.capacity == 0 && info.delegators <= 1) {
+      proxies.erase(info);
+   } else {
+      proxies.modify(info, eosio::same_payer, [&](proxy_info& row) {
+         --row.delegators;
+      });
+   }
+}
+
+/**
+ * @brief Take over the weight of more standing delegators in a poll.
+ *        A proxy's vote collects the first standing_batch delegators; this goes on
+ *        from there, max_rows delegators per call, so a proxy with thousands of
+ *        delegators votes in a handful of transactions. It can run before or after
+ *        the proxy's vote: once voted, each collected weight goes straight to the
+ *        option's tally. Delegators that set the proxy after the collection passed
+ *        their account aren't collected in that poll, they delegate there directly.
+ * @param id        Poll id.
+ * @param proxy     Proxy account, pays for the delegation rows.
+ * @param max_rows  Maximum number of standing delegators visited in this call.
+ * @abi action
+ */
+void pollgf::collect(pollgf::poll_id_t id, eosio::name proxy, uint64_t max_rows) {
+
+   eosio::require_auth(proxy);
+   eosio::check(max_rows > 0, "max_rows must be positive");
+
+   summary_table summaries(get_self(), get_self().value);
+   const poll_summary & s = summaries.get(id, "Poll with this id does not exist");
+   eosio::check(s.is_open(), "Poll is closed");
+
+   vote_table votes(get_self(), id);
+   delegation_table delegations(get_self(), id);
+   eosio::check(delegations.find(proxy.value) == delegations.end(), "Proxy delegated its own vote in this poll");
+
+   switch (s.kind) {
+      case POLL_SNAPSHOT:
+         collect_standing<snapshot_kind>(id, votes, proxy, max_rows);
+         break;
+      case POLL_TOKEN:
+         collect_standing<token_kind>(id, votes, proxy, max_rows);
+         break;
+      default:
+         collect_standing<plain_kind>(id, votes, proxy, max_rows);
+   }
+}
+
+/**
+ * @brief Close a poll before its closing time.
+ *        Only the poll owner can close it; cleanup may erase it after cleanup_delay.
+ * @param id  Poll id.
+ * @abi action
+ */
+void pollgf::closepoll(pollgf::poll_id_t id) {
 
    const poll & p = _polls.get(id, "Poll with this id does not exist");
+   eosio::require_auth(p.owner);
+
+   summary_table summaries(get_self(), get_self().value);
+   const poll_summary & s = summaries.get(id, "Poll with this id does not exist");
+   eosio::check(s.is_open(), "Poll is already closed");
+
+   summaries.modify(s, eosio::same_payer, [&](poll_summary& row) {
+      row.closed    = true;
+      row.closes_at = eosio::current_time_point().sec_since_epoch();
+   });
+}
+
+/**
+ * @brief Erase expired polls and their votes, tallies and snapshot rows.
+ *        A poll is expired once cleanup_delay has passed since it closed.
+ *        Work is bounded by max_rows erased rows, so the sweep proceeds
+ *        incrementally across calls. Anyone can call it.
+ * @param max_rows  Maximum number of rows to erase in this call.
+ * @abi action
+ */
+void pollgf::cleanup(uint64_t max_rows) {
+
+   eosio::check(max_rows > 0, "max_rows must be positive");
+
+   summary_table summaries(get_self(), get_self().value);
+   auto by_close = summaries.get_index<"byclose"_n>();
+
+   // Compared in 64 bits, so a late closing time can't wrap around and look expired
+   const uint64_t current = eosio::current_time_point().sec_since_epoch();
+   uint64_t budget = max_rows;
+
+   auto itr = by_close.begin();
+   while (budget > 0 && itr != by_close.end() &&
+          uint64_t(itr->closes_at) + cleanup_delay <= current) {
+      const poll_id_t id = itr->id;
+
+      // Per-poll rows first, so a partially swept poll is resumed next call
+      vote_table votes(get_self(), id);
+      budget -= erase_rows(votes, budget);
+      tally_table tallies(get_self(), id);
+      budget -= erase_rows(tallies, budget);
+      weight_table weights(get_self(), id);
+      budget -= erase_rows(weights, budget);
+      delegation_table delegations(get_self(), id);
+      budget -= erase_rows(delegations, budget);
+      proxy_table proxies(get_self(), id);
+      budget -= erase_rows(proxies, budget);
+      collect_table cursors(get_self(), id);
+      budget -= erase_rows(cursors, budget);
+      if (budget == 0) break;
+
+      auto pitr = _polls.find(id);
+      if (pitr != _polls.end()) {
+         _polls.erase(pitr);
+      }
+      token_poll_table tokens(get_self(), get_self().value);
+      auto titr = tokens.find(id);
+      if (titr != tokens.end()) {
+         tokens.erase(titr);
+      }
+      itr = by_close.erase(itr);
+      --budget;
+   }
+}
+
+/**
+ * @brief Erase polls of the layout before summary rows.
+ *        Legacy polls were created before any current poll, so they are the
+ *        lowest ids of the poll table: the sweep stops at the first poll that has
+ *        a summary row. Each poll's final results are printed before its row and
+ *        reverse index entry are erased, so they stay in the action trace.
+ *        Anyone can call it; the RAM goes back to the poll creators.
+ * @param max_rows  Maximum number of polls to erase in this call.
+ * @abi action
+ */
+void pollgf::droppolls(uint64_t max_rows) {
+
+   eosio::check(max_rows > 0, "max_rows must be positive");
 
-   eosio_assert(option_id < p.results.size(), "Option with this id does not exist");
+   poll_key_table keys(get_self(), get_self().value);
+   legacy_poll_table legacy(get_self(), get_self().value);
+   summary_table summaries(get_self(), get_self().value);
 
-   vote_table votes(get_self(), voter);
-   eosio_assert(votes.find(p.id) == votes.end(), "This account has already voted in this poll");
+   uint64_t erased = 0;
+   auto kitr = keys.begin();
+   while (erased < max_rows && kitr != keys.end() && summaries.find(kitr->id) == summaries.end()) {
+      const poll_id_t id = kitr->id;
+      ++kitr;
 
-   if (p.is_token_poll)
-      store_token_vote(p, votes, option_id);
-   else
-      store_vote(p, votes, option_id, 1);
+      auto itr = legacy.find(id);
+      eosio::print("Legacy poll ", id, " results:");
+      for (const auto& r : itr->results) {
+         eosio::print(" ", r.name, "=", r.votes);
+      }
+      eosio::print("\n");
 
-   eosio::print("Vote stored!");
+      legacy.erase(itr);
+      ++erased;
+   }
+}
+
+/**
+ * @brief Erase the legacy vote rows of one voter (scope = voter).
+ *        The contract can't list scopes: voters are found off chain with
+ *        get_table_by_scope on the votes table, skipping the poll id scopes.
+ *        Anyone can call it; the RAM goes back to the voter.
+ * @param voter     Voter whose legacy votes are erased.
+ * @param max_rows  Maximum number of rows to erase in this call.
+ * @abi action
+ */
+void pollgf::dropvotes(eosio::name voter, uint64_t max_rows) {
+
+   eosio::check(max_rows > 0, "max_rows must be positive");
+
+   // Current votes are scoped by poll id; never sweep one of those scopes
+   summary_table summaries(get_self(), get_self().value);
+   eosio::check(summaries.find(voter.value) == summaries.end(), "This scope holds the votes of a current poll");
+
+   legacy_vote_table votes(get_self(), voter.value);
+   erase_rows(votes, max_rows);
+}
+
+/**
+ * @brief Return the vote totals of a poll, one entry per option.
+ *        Read-only: the tally can be fetched with a read-only transaction
+ *        instead of reading the tally table row by row.
+ * @param id  Poll id.
+ * @abi action
+ */
+std::vector<uint64_t> pollgf::gettally(pollgf::poll_id_t id) {
+
+   summary_table summaries(get_self(), get_self().value);
+   const poll_summary & s = summaries.get(id, "Poll with this id does not exist");
+
+   // Tally rows exist only for options that received a vote, in option order
+   tally_table tallies(get_self(), id);
+   auto itr = tallies.begin();
+
+   std::vector<uint64_t> totals(s.option_count, 0);
+   for (; itr != tallies.end() && itr->option_id < s.option_count; ++itr) {
+      totals[itr->option_id] = itr->votes;
+   }
+   return totals;
+}
+
+#ifdef GF_INSTRUMENTATION
+/**
+ * @brief Instrumentation sink. Does nothing; indexers read the counters
+ *        from the action trace.
+ * @abi action
+ */
+void pollgf::log(const gf_instrumentation::counters& event) {
 }
 
+#endif
 // Macro to register the contract's actions
-EOSIO_ABI(pollgf, (newpoll)(newtokenpoll)(vote))
\ No newline at end of file
+#ifdef GF_INSTRUMENTATION
+EOSIO_DISPATCH(pollgf, (newpoll)(newtokenpoll)(newsnappoll)(loadweights)(sealpoll)(vote)(delegate)(undelegate)(regproxy)(setproxy)(clearproxy)(collect)(closepoll)(cleanup)(droppolls)(dropvotes)(gettally)(log))
+#else
+EOSIO_DISPATCH(pollgf, (newpoll)(newtokenpoll)(newsnappoll)(loadweights)(sealpoll)(vote)(delegate)(undelegate)(regproxy)(setproxy)(clearproxy)(collect)(closepoll)(cleanup)(droppolls)(dropvotes)(gettally))
+#endif
\ No newline at end of file
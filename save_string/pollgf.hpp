@@ -1,128 +1,561 @@
 #pragma once
 
-#include <eosiolib/eosio.hpp>
-#include <cmath>
-#include "eosio.token.hpp"
+#include <eosio/asset.hpp>
+#include <eosio/crypto.hpp>
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include "instrumentation.hpp"
 
 /**
  * @class pollgf
  * EOSIO voting contract, supporting normal and token-weighted polls.
  */
-class pollgf : public eosio::contract {
+class [[eosio::contract("pollgf")]] pollgf : public eosio::contract {
    public:
       typedef uint64_t                 poll_id_t;      // Type for poll IDs
       typedef std::vector<std::string> option_names_t; // List of option strings
       typedef eosio::extended_symbol   token_info_t;   // Token info (symbol+contract)
       typedef uint8_t                  option_id_t;    // Option index type
 
-      pollgf(account_name contract_name)
-         : eosio::contract(contract_name), _polls(contract_name, contract_name) {}
+      pollgf(eosio::name receiver, eosio::name code, eosio::datastream<const char*> ds)
+         : eosio::contract(receiver, code, ds), _polls(receiver, receiver.value) {}
+
+      // Maximum length of one option name, in bytes
+      static const uint32_t max_option_size = 64;
+
+      // Separator of option names in poll::options
+      static const char option_separator = '\n';
+
+      // Poll kinds, stored in poll_summary::kind
+      static const uint8_t POLL_PLAIN    = 0; // One account, one vote
+      static const uint8_t POLL_TOKEN    = 1; // Weighted by the live token balance
+      static const uint8_t POLL_SNAPSHOT = 2; // Weighted by an imported balance snapshot
+
+      // Compile-time poll kind tags, selecting the vote weight of the vote path
+      struct plain_kind {};
+      struct token_kind {};
+      struct snapshot_kind {};
 
       /**
-       * @struct option
-       * Stores the name of a voting option.
+       * @struct poll
+       * Stores a poll (question, options, etc).
+       * Vote tallies live in the separate tally table, so voting never rewrites this row.
+       * Token settings live in the token poll table, so plain polls don't store them.
        */
-      struct option {
-         std::string name;
+      struct [[eosio::table]] poll {
+         poll_id_t      id;            // Poll unique id
+         std::string    question;      // Poll question text
+         std::string    options;       // Option names in option order, separated by option_separator
+         eosio::name    owner;         // Poll creator (imports the snapshot, if any)
+
+         uint64_t primary_key() const { return id; }
 
-         option(std::string name) : name(name) {}
-         option() {}
+         // Initializes poll object with all values, packing the option names.
+         void set(poll_id_t id, const std::string& question,
+                  const option_names_t& options, eosio::name owner);
 
-         EOSLIB_SERIALIZE(option, (name))
+         EOSLIB_SERIALIZE(poll, (id)(question)(options)(owner))
       };
 
       /**
-       * @struct option_result
-       * Extends option by also tracking the number of votes.
+       * @struct token_poll
+       * Token settings of a token-weighted or snapshot poll (scope = contract).
+       * Only read by the vote path of those kinds.
        */
-      struct option_result : option {
-         double votes = 0; // Vote total (can be fractional for token-weighted polls)
-
-         option_result(const std::string& name, uint64_t votes) : option(name), votes(votes) {}
-         option_result(const std::string& name) : option_result(name, 0) {}
-         option_result() {}
+      struct [[eosio::table("tokenpoll")]] token_poll {
+         poll_id_t      id;                  // Poll unique id
+         token_info_t   token;               // Token info (symbol+contract)
+         bool           is_sealed = false;   // Snapshot polls: true once the snapshot is final and voting is open
 
-         EOSLIB_SERIALIZE(option_result, (name)(votes))
+         uint64_t primary_key() const { return id; }
+         EOSLIB_SERIALIZE(token_poll, (id)(token)(is_sealed))
       };
 
-      typedef std::vector<option_result> option_results;
-
       /**
-       * @struct poll
-       * Stores a poll (question, options, vote tallies, etc).
+       * @struct poll_summary
+       * Compact, fixed-size listing row for a poll, for front ends.
+       * The reverse index returns the newest polls first: page with
+       * get_table_rows on index 2, using ~(last seen id) + 1 as the next lower bound.
+       * The byclose index orders polls by closing time for the cleanup sweep.
        */
-      //@abi table
-      struct poll {
-         poll_id_t      id;            // Poll unique id
-         std::string    question;      // Poll question text
-         option_results results;       // Array of results (option name + vote tally)
-         bool           is_token_poll = false; // True if poll is token-weighted
-         token_info_t   token;         // Token info (if token-weighted)
+      struct [[eosio::table("summary")]] poll_summary {
+         poll_id_t            id;             // Poll unique id
+         eosio::checksum256   question_hash;  // sha256 of the question text
+         uint8_t              option_count;   // Number of options
+         bool                 closed = false; // True once the poll no longer accepts votes
+         uint32_t             closes_at;      // Time (seconds since epoch) when voting closes
+         uint8_t              kind = POLL_PLAIN; // POLL_PLAIN, POLL_TOKEN or POLL_SNAPSHOT
 
          uint64_t primary_key() const { return id; }
 
-         // Used for reverse order lookup/indexing (optional)
+         // Newest-first ordering for paged listings
          uint64_t get_reverse_key() const { return ~id; }
 
-         // Initializes poll object with all values and options.
-         void set(poll_id_t id, const std::string& question,
-                  const option_names_t& options, bool is_token_poll,
-                  token_info_t token);
+         // Ordering by closing time for the cleanup sweep
+         uint64_t get_close_key() const { return closes_at; }
+
+         // True if the poll accepts votes right now
+         bool is_open() const { return !closed && eosio::current_time_point().sec_since_epoch() < closes_at; }
 
-         EOSLIB_SERIALIZE(poll, (id)(question)(results)(is_token_poll)(token))
+         EOSLIB_SERIALIZE(poll_summary, (id)(question_hash)(option_count)(closed)(closes_at)(kind))
+      };
+
+      /**
+       * @struct option_tally
+       * Vote total of one option (scope = poll id).
+       * Fixed-size row, so a vote only rewrites a few bytes.
+       */
+      struct [[eosio::table("tally")]] option_tally {
+         uint64_t    option_id;  // Option index within the poll
+         uint64_t    votes = 0;  // Vote total (token base units for token-weighted polls,
+                                 // divide by 10^precision of the poll token when reading)
+
+         uint64_t primary_key() const { return option_id; }
+         EOSLIB_SERIALIZE(option_tally, (option_id)(votes))
+      };
+
+      /**
+       * @struct voter_weight
+       * Snapshot balance of one voter (scope = poll id), in token base units.
+       */
+      struct [[eosio::table("weights")]] voter_weight {
+         eosio::name  voter;   // Voter account
+         int64_t      amount;  // Snapshot balance in token base units
+
+         uint64_t primary_key() const { return voter.value; }
+         EOSLIB_SERIALIZE(voter_weight, (voter)(amount))
       };
 
       /**
        * @struct poll_vote
-       * Stores a user's vote in a poll (per user per poll).
+       * Stores a user's vote in a poll (scope = poll id, one row per voter).
        */
-      //@abi table votes
-      struct poll_vote {
-         poll_id_t   poll_id;    // The poll id this vote belongs to
-         option_id_t option_id;  // Chosen option index
+      struct [[eosio::table("votes")]] poll_vote {
+         eosio::name  voter;      // The account that voted
+         option_id_t  option_id;  // Chosen option index
+
+         uint64_t primary_key() const { return voter.value; }
+         EOSLIB_SERIALIZE(poll_vote, (voter)(option_id))
+      };
+
+      /**
+       * @struct delegation
+       * A voter's delegation of their vote to a proxy (scope = poll id).
+       * The weight is taken when delegating, as it is for a direct vote.
+       */
+      struct [[eosio::table("delegations")]] delegation {
+         eosio::name  voter;   // Delegating account
+         eosio::name  proxy;   // Account voting on the voter's behalf
+         uint64_t     weight;  // Weight delegated to the proxy
+
+         uint64_t primary_key() const { return voter.value; }
+         EOSLIB_SERIALIZE(delegation, (voter)(proxy)(weight))
+      };
+
+      /**
+       * @struct proxy_weight
+       * Sum of the weights delegated to a proxy (scope = poll id).
+       * Added to the proxy's own weight when it votes.
+       */
+      struct [[eosio::table("proxies")]] proxy_weight {
+         eosio::name  proxy;          // Proxy account
+         uint64_t     delegated = 0;  // Sum of delegation weights
+
+         uint64_t primary_key() const { return proxy.value; }
+         EOSLIB_SERIALIZE(proxy_weight, (proxy)(delegated))
+      };
+
+      /**
+       * @struct poll_key
+       * Leading id of a poll row. The legacy poll layout starts with the id too, so
+       * reading rows through it never unpacks a row of the other layout.
+       */
+      struct poll_key {
+         poll_id_t      id;   // Poll unique id
+
+         uint64_t primary_key() const { return id; }
+         EOSLIB_SERIALIZE(poll_key, (id))
+      };
+
+      /**
+       * @struct legacy_result
+       * Option name and vote total of a legacy poll row.
+       */
+      struct legacy_result {
+         std::string    name;  // Option name
+         double         votes; // Vote total
+
+         EOSLIB_SERIALIZE(legacy_result, (name)(votes))
+      };
+
+      /**
+       * @struct legacy_poll
+       * Poll row of the layout before summary rows (same "poll" table, scope = contract).
+       * These polls have no summary row, so nothing but droppolls reads them; not part of the ABI.
+       */
+      struct legacy_poll {
+         poll_id_t                  id;            // Poll unique id
+         std::string                question;      // Poll question text
+         std::vector<legacy_result> results;       // Option names with their vote totals
+         bool                       is_token_poll; // True if poll is token-weighted
+         token_info_t               token;         // Token info (if token-weighted)
+
+         uint64_t primary_key() const { return id; }
+         uint64_t get_reverse_key() const { return ~id; }
+         EOSLIB_SERIALIZE(legacy_poll, (id)(question)(results)(is_token_poll)(token))
+      };
+
+      /**
+       * @struct legacy_vote
+       * Vote row of the layout before summary rows (scope = voter, one row per poll voted in).
+       */
+      struct legacy_vote {
+         poll_id_t      poll_id;    // The poll id this vote belongs to
+         option_id_t    option_id;  // Chosen option index
 
          uint64_t primary_key() const { return poll_id; }
-         EOSLIB_SERIALIZE(poll_vote, (poll_id)(option_id))
+         EOSLIB_SERIALIZE(legacy_vote, (poll_id)(option_id))
       };
 
-      // Table of polls, with a reverse index (not strictly needed)
-      typedef eosio::multi_index<N(poll), poll,
-         eosio::indexed_by<N(reverse),
-            eosio::const_mem_fun<poll, uint64_t, &poll::get_reverse_key>
+      /**
+       * @struct standing_proxy
+       * A voter's standing delegation to a proxy, valid for every poll (scope = contract).
+       * When the proxy votes or collects, each standing delegator that has neither voted
+       * nor delegated in the poll gets a delegation row there, paid by the proxy.
+       */
+      struct [[eosio::table("stdproxies")]] standing_proxy {
+         eosio::name  voter;  // Delegating account
+         eosio::name  proxy;  // Account voting on the voter's behalf
+
+         uint64_t primary_key() const { return voter.value; }
+         uint128_t get_proxy_key() const { return proxy_key(proxy, voter.value); }
+         EOSLIB_SERIALIZE(standing_proxy, (voter)(proxy))
+
+         // Key of the byproxy index: the delegators of a proxy in voter order
+         static uint128_t proxy_key(eosio::name proxy, uint64_t voter) {
+            return (uint128_t(proxy.value) << 64) | voter;
+         }
+      };
+
+      /**
+       * @struct proxy_info
+       * An account accepting standing delegators (scope = contract), paid by the proxy.
+       * The proxy pays for the delegation rows of its standing delegators in every
+       * poll it votes in, so it chooses how many it takes.
+       */
+      struct [[eosio::table("proxyinfo")]] proxy_info {
+         eosio::name  proxy;           // Proxy account
+         uint32_t     capacity = 0;    // Most standing delegators accepted
+         uint32_t     delegators = 0;  // Current standing delegators
+
+         uint64_t primary_key() const { return proxy.value; }
+         EOSLIB_SERIALIZE(proxy_info, (proxy)(capacity)(delegators))
+      };
+
+      /**
+       * @struct collect_cursor
+       * How far the standing delegators of a proxy were collected in a poll (scope = poll id).
+       */
+      struct [[eosio::table("collects")]] collect_cursor {
+         eosio::name  proxy;         // Proxy account
+         uint64_t     next = 0;      // Lowest delegator account value not yet collected
+         bool         done = false;  // True once every delegator was collected
+
+         uint64_t primary_key() const { return proxy.value; }
+         EOSLIB_SERIALIZE(collect_cursor, (proxy)(next)(done))
+      };
+
+      /**
+       * @struct token_account
+       * Balance row of the poll token's contract (standard eosio.token layout, scope = owner).
+       * Only read, so it is not part of this contract's ABI.
+       */
+      struct token_account {
+         eosio::asset   balance;
+
+         uint64_t primary_key() const { return balance.symbol.code().raw(); }
+      };
+
+      /**
+       * @struct token_stats
+       * Supply row of the poll token's contract (standard eosio.token layout, scope = symbol code).
+       */
+      struct token_stats {
+         eosio::asset   supply;
+         eosio::asset   max_supply;
+         eosio::name    issuer;
+
+         uint64_t primary_key() const { return supply.symbol.code().raw(); }
+      };
+
+      // Balances in the token contract (scope = owner)
+      typedef eosio::multi_index<"accounts"_n, token_account> token_account_table;
+
+      // Token supplies in the token contract (scope = symbol code)
+      typedef eosio::multi_index<"stat"_n, token_stats> token_stats_table;
+
+      // Table of polls
+      typedef eosio::multi_index<"poll"_n, poll> poll_table;
+
+      // Table of token settings of token-weighted and snapshot polls
+      typedef eosio::multi_index<"tokenpoll"_n, token_poll> token_poll_table;
+
+      // Table of poll listing rows, with a reverse index for newest-first paging
+      // and a closing time index for the cleanup sweep
+      typedef eosio::multi_index<"summary"_n, poll_summary,
+         eosio::indexed_by<"reverse"_n,
+            eosio::const_mem_fun<poll_summary, uint64_t, &poll_summary::get_reverse_key>
+         >,
+         eosio::indexed_by<"byclose"_n,
+            eosio::const_mem_fun<poll_summary, uint64_t, &poll_summary::get_close_key>
+         >
+      > summary_table;
+
+      // Table of votes in a poll (scope = poll id)
+      typedef eosio::multi_index<"votes"_n, poll_vote> vote_table;
+
+      // Table of per-option vote totals (scope = poll id)
+      typedef eosio::multi_index<"tally"_n, option_tally> tally_table;
+
+      // Table of snapshot voter weights (scope = poll id)
+      typedef eosio::multi_index<"weights"_n, voter_weight> weight_table;
+
+      // Table of vote delegations (scope = poll id)
+      typedef eosio::multi_index<"delegations"_n, delegation> delegation_table;
+
+      // Table of delegated weight per proxy (scope = poll id)
+      typedef eosio::multi_index<"proxies"_n, proxy_weight> proxy_table;
+
+      // Table of standing delegations, with an index of the delegators of each proxy
+      typedef eosio::multi_index<"stdproxies"_n, standing_proxy,
+         eosio::indexed_by<"byproxy"_n,
+            eosio::const_mem_fun<standing_proxy, uint128_t, &standing_proxy::get_proxy_key>
          >
-      > poll_table;
+      > standing_proxy_table;
+
+      // Table of accounts accepting standing delegators
+      typedef eosio::multi_index<"proxyinfo"_n, proxy_info> proxy_info_table;
+
+      // Table of standing delegation collection progress (scope = poll id)
+      typedef eosio::multi_index<"collects"_n, collect_cursor> collect_table;
+
+      // Poll ids of either layout (scope = contract), read only
+      typedef eosio::multi_index<"poll"_n, poll_key> poll_key_table;
+
+      // Table of legacy polls, with the reverse index their rows were stored with
+      typedef eosio::multi_index<"poll"_n, legacy_poll,
+         eosio::indexed_by<"reverse"_n,
+            eosio::const_mem_fun<legacy_poll, uint64_t, &legacy_poll::get_reverse_key>
+         >
+      > legacy_poll_table;
+
+      // Table of legacy votes (scope = voter)
+      typedef eosio::multi_index<"votes"_n, legacy_vote> legacy_vote_table;
+
+      // Most standing delegators collected by a proxy's vote; collect takes the rest
+      static const uint64_t standing_batch = 50;
+
+      // Seconds a closed poll stays readable before cleanup may erase it
+      static const uint32_t cleanup_delay = 7 * 24 * 60 * 60;
 
-      // Table of votes for each user (scope = user account)
-      typedef eosio::multi_index<N(votes), poll_vote> vote_table;
+      // Longest poll duration accepted, in seconds
+      static const uint32_t max_duration = 365 * 24 * 60 * 60;
 
-      //@abi action
-      void newpoll(const std::string& question, account_name creator,
-                   const std::vector<std::string>& options);
+      [[eosio::action]]
+      void newpoll(const std::string& question, eosio::name creator,
+                   const std::vector<std::string>& options, uint32_t duration);
 
-      //@abi action
-      void newtokenpoll(const std::string& question, account_name payer,
+      [[eosio::action]]
+      void newtokenpoll(const std::string& question, eosio::name payer,
                         const std::vector<std::string>& options,
-                        token_info_t token);
+                        token_info_t token, uint32_t duration);
 
-      //@abi action
-      void vote(poll_id_t id, account_name voter, option_id_t option_id);
+      [[eosio::action]]
+      void newsnappoll(const std::string& question, eosio::name owner,
+                       const std::vector<std::string>& options,
+                       token_info_t token, uint32_t duration);
+
+      [[eosio::action]]
+      void loadweights(poll_id_t id, const std::vector<voter_weight>& weights);
+
+      [[eosio::action]]
+      void sealpoll(poll_id_t id);
+
+      [[eosio::action]]
+      void vote(poll_id_t id, eosio::name voter, option_id_t option_id);
+
+      [[eosio::action]]
+      void delegate(poll_id_t id, eosio::name voter, eosio::name proxy);
+
+      [[eosio::action]]
+      void undelegate(poll_id_t id, eosio::name voter);
+
+      [[eosio::action]]
+      void regproxy(eosio::name proxy, uint32_t capacity);
+
+      [[eosio::action]]
+      void setproxy(eosio::name voter, eosio::name proxy);
+
+      [[eosio::action]]
+      void clearproxy(eosio::name voter);
+
+      [[eosio::action]]
+      void collect(poll_id_t id, eosio::name proxy, uint64_t max_rows);
+
+      [[eosio::action]]
+      void closepoll(poll_id_t id);
+
+      [[eosio::action]]
+      void cleanup(uint64_t max_rows);
+
+      [[eosio::action]]
+      void droppolls(uint64_t max_rows);
+
+      [[eosio::action]]
+      void dropvotes(eosio::name voter, uint64_t max_rows);
+
+      [[eosio::action, eosio::read_only]]
+      std::vector<uint64_t> gettally(poll_id_t id);
+
+#ifdef GF_INSTRUMENTATION
+      // No-op sink for the cost counters of vote, sent inline by the contract.
+      [[eosio::action]]
+      void log(const gf_instrumentation::counters& event);
+#endif
 
    private:
       // Stores poll on-chain.
-      void store_poll(const std::string& question, account_name owner,
-                      const option_names_t& options,
-                      bool is_token_poll, token_info_t token);
+      void store_poll(const std::string& question, eosio::name owner,
+                      const option_names_t& options, uint8_t kind,
+                      token_info_t token, uint32_t duration);
+
+      // Stores a user's vote and increments the option's tally.
+      void store_vote(poll_id_t id, vote_table& votes, eosio::name voter,
+                      option_id_t option_id, uint64_t weight);
+
+      // Stores a user's vote with the weight of the poll kind.
+      // Each kind is its own instantiation, so the plain path never touches token data.
+      // A proxy votes with its own weight plus the weight delegated to it, standing
+      // delegations included, so its own weight may be zero.
+      template<typename Kind>
+      void cast_vote(poll_id_t id, vote_table& votes, eosio::name voter,
+                     option_id_t option_id) {
+         const uint64_t own = vote_weight(Kind(), id, voter);
+         collect_standing<Kind>(id, votes, voter, standing_batch);
+         const uint64_t weight = own + delegated_weight(id, voter);
+         eosio::check(weight >= own, "Vote weight overflow");
+         eosio::check(weight > 0, "Voter must have more than 0 tokens to participate in a poll!");
+         store_vote(id, votes, voter, option_id, weight);
+      }
 
-      // Stores a user's vote and increments result.
-      void store_vote(const poll& p, vote_table& votes, option_id_t option_id, double weight);
+      // Turns up to max_rows standing delegations to proxy into delegations of the poll,
+      // paid by the proxy, resuming where the last call in the poll stopped.
+      // Delegators that voted, delegated or act as a proxy in the poll, or have no weight, are skipped.
+      template<typename Kind>
+      void collect_standing(poll_id_t id, vote_table& votes, eosio::name proxy, uint64_t max_rows) {
+         // Plain voters have no proxy row; they get no cursor row either
+         proxy_info_table infos(get_self(), get_self().value);
+         auto iitr = infos.find(proxy.value);
+         _probe.read();
+         if (iitr == infos.end() || iitr->delegators == 0)
+            return;
 
-      // Stores a user's vote, using their token balance as weight.
-      void store_token_vote(const poll& p, vote_table& votes, option_id_t option_id);
+         collect_table cursors(get_self(), id);
+         auto citr = cursors.find(proxy.value);
+         _probe.read();
+         if (citr != cursors.end() && citr->done)
+            return;
 
-      // Converts an EOSIO asset to a weight (as a floating-point number)
-      double to_weight(const eosio::asset& stake) {
-         return stake.amount / std::pow(10, stake.symbol.precision());
+         standing_proxy_table standing(get_self(), get_self().value);
+         auto by_proxy = standing.get_index<"byproxy"_n>();
+         delegation_table delegations(get_self(), id);
+
+         uint64_t next = citr == cursors.end() ? 0 : citr->next;
+         auto itr = by_proxy.lower_bound(standing_proxy::proxy_key(proxy, next));
+         _probe.read();
+         for (uint64_t rows = 0; rows < max_rows && itr != by_proxy.end() && itr->proxy == proxy; ++rows) {
+            const eosio::name voter = itr->voter;
+            if (!takes_part(id, votes, delegations, voter)) {
+               const uint64_t weight = vote_weight(Kind(), id, voter);
+               if (weight > 0)
+                  store_delegation(id, voter, proxy, weight, proxy);
+            }
+            next = voter.value + 1;
+            ++itr;
+            _probe.read();
+         }
+         const bool done = itr == by_proxy.end() || itr->proxy != proxy;
+
+         if (citr == cursors.end()) {
+            citr = cursors.emplace(proxy, [&](collect_cursor& c) {
+               c.proxy = proxy;
+               c.next  = next;
+               c.done  = done;
+            });
+         } else {
+            cursors.modify(citr, eosio::same_payer, [&](collect_cursor& c) {
+               c.next = next;
+               c.done = done;
+            });
+         }
+         _probe.write(*citr);
+      }
+
+      // Gives up one standing delegator of proxy; the row goes once it is unregistered and empty.
+      void release_delegator(proxy_info_table& proxies, eosio::name proxy);
+
+      // Stores a delegation with the weight of the poll kind.
+      template<typename Kind>
+      void cast_delegation(poll_id_t id, eosio::name voter, eosio::name proxy) {
+         const uint64_t weight = vote_weight(Kind(), id, voter);
+         eosio::check(weight > 0, "Voter must have more than 0 tokens to participate in a poll!");
+         store_delegation(id, voter, proxy, weight, voter);
+      }
+
+      // Stores a delegation, adding its weight to the proxy and, if the proxy voted, to its option.
+      // payer pays for the rows.
+      void store_delegation(poll_id_t id, eosio::name voter, eosio::name proxy,
+                            uint64_t weight, eosio::name payer);
+
+      // True if voter voted, delegated or acts as a proxy in the poll.
+      bool takes_part(poll_id_t id, vote_table& votes, delegation_table& delegations,
+                      eosio::name voter);
+
+      // Sum of the weights delegated to proxy.
+      uint64_t delegated_weight(poll_id_t id, eosio::name proxy);
+
+      // Adds (or, with subtract, removes) weight to the tally of the option proxy voted for.
+      // Does nothing if proxy has not voted.
+      void adjust_proxy_tally(poll_id_t id, eosio::name proxy, uint64_t weight, bool subtract);
+
+      // Vote weight of a plain poll: one account, one vote.
+      uint64_t vote_weight(plain_kind, poll_id_t id, eosio::name voter) { return 1; }
+
+      // Vote weight of a token poll: the voter's token balance (0 without a balance row).
+      uint64_t vote_weight(token_kind, poll_id_t id, eosio::name voter);
+
+      // Vote weight of a snapshot poll: the voter's imported snapshot balance (0 if not imported).
+      uint64_t vote_weight(snapshot_kind, poll_id_t id, eosio::name voter);
+
+      // Asserts that the token exists in its contract.
+      void check_token_exists(token_info_t token);
+
+      // Returns the token settings of a snapshot poll that is still being loaded.
+      const token_poll& get_unsealed_snapshot(token_poll_table& tokens, poll_id_t id);
+
+      // Erases up to max_rows rows of a table, returns the number of rows erased.
+      template<typename Table>
+      uint64_t erase_rows(Table& table, uint64_t max_rows) {
+         uint64_t erased = 0;
+         for (auto itr = table.begin(); erased < max_rows && itr != table.end(); ++erased) {
+            itr = table.erase(itr);
+         }
+         return erased;
       }
 
       poll_table _polls; // Main on-chain poll storage table
+
+      // Cost counters of the running action: the helpers count their table operations here,
+      // vote resets it on entry and emits it at the end.
+      gf_instrumentation::probe _probe{0};
 };
\ No newline at end of file
@@ -9,13 +9,13 @@ ACTION stablecoin::create( name issuer, asset maximum_supply ) {
     require_auth( _self );
 
     auto sym = maximum_supply.symbol;
-    eosio_assert( sym.is_valid(), "invalid symbol name" );
-    eosio_assert( maximum_supply.is_valid(), "invalid supply");
-    eosio_assert( maximum_supply.amount > 0, "max-supply must be positive");
+    check( sym.is_valid(), "invalid symbol name" );
+    check( maximum_supply.is_valid(), "invalid supply");
+    check( maximum_supply.amount > 0, "max-supply must be positive");
 
     stats statstable( _self, sym.code().raw() );
     auto existing = statstable.find( sym.code().raw() );
-    eosio_assert( existing == statstable.end(), "token with symbol already exists" );
+    check( existing == statstable.end(), "token with symbol already exists" );
 
     statstable.emplace( _self, [&]( auto& s ) {
        s.supply.symbol = maximum_supply.symbol; // начальная эмиссия = 0
@@ -29,23 +29,24 @@ ACTION stablecoin::create( name issuer, asset maximum_supply ) {
  * - Can only be called by the token issuer.
  * - The issued amount is added to the issuer's balance and increases the total supply.
  * - Only a positive number of tokens can be issued.
- * - If the specified recipient is not the issuer, an internal transfer is immediately called.
+ * - If the specified recipient is not the issuer, an internal transfer is immediately called,
+ *   or, in direct mint mode, the recipient is credited here and notified with a minted action.
  */
 ACTION stablecoin::issue( name to, asset quantity, string memo ) {
     auto sym = quantity.symbol;
-    eosio_assert( sym.is_valid(), "invalid symbol name" );
-    eosio_assert( memo.size() <= 256, "memo has more than 256 bytes" );
+    check( sym.is_valid(), "invalid symbol name" );
+    check( memo.size() <= 256, "memo has more than 256 bytes" );
 
     stats statstable( _self, sym.code().raw() );
     auto existing = statstable.find( sym.code().raw() );
-    eosio_assert( existing != statstable.end(), "token with symbol does not exist, create token before issue" );
+    check( existing != statstable.end(), "token with symbol does not exist, create token before issue" );
     const auto& st = *existing;
 
     require_auth( st.issuer );
-    eosio_assert( quantity.is_valid(), "invalid quantity" );
-    eosio_assert( quantity.amount > 0, "must issue positive quantity" );
+    check( quantity.is_valid(), "invalid quantity" );
+    check( quantity.amount > 0, "must issue positive quantity" );
 
-    eosio_assert( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
+    check( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
 
     // We increase supply, as well as max_supply, if supply suddenly goes beyond max_supply (it can be removed if there is no need to "expand" the limit)
     statstable.modify( st, same_payer, [&]( auto& s ) {
@@ -55,11 +56,28 @@ ACTION stablecoin::issue( name to, asset quantity, string memo ) {
        }
     });
 
+    if( to != st.issuer ) {
+       const auto cfg = get_config();
+       if( cfg.direct_mint ) {
+          // Same checks the inline transfer would do, without a second action
+          check( !cfg.paused, "contract is paused." );
+          check_blacklist( cfg, st.issuer, "account blacklisted(from)" );
+          check_blacklist( cfg, to, "account blacklisted(to)" );
+          check( is_account( to ), "to account does not exist");
+
+          add_balance( to, quantity, st.issuer );
+
+          // Transfer-shaped record for trackers; no authorization, so no eosio.code permission
+          minted_action( _self, std::vector<permission_level>() ).send( st.issuer, to, quantity, memo );
+          return;
+       }
+    }
+
     add_balance( st.issuer, quantity, st.issuer );
 
     if( to != st.issuer ) {
        // If the recipient is not the issuer, we transfer tokens to him (from the issuer)
-       SEND_INLINE_ACTION( *this, transfer, {st.issuer, "active"_n}, {st.issuer, to, quantity, memo} );
+       transfer_action( _self, {st.issuer, "active"_n} ).send( st.issuer, to, quantity, memo );
     }
 }
 
@@ -70,33 +88,82 @@ ACTION stablecoin::issue( name to, asset quantity, string memo ) {
  * - Checks for the presence of the recipient account.
  */
 ACTION stablecoin::transfer( name from, name to, asset quantity, string memo ) {
-    eosio_assert( is_paused(), "contract is paused." );
+    _probe = gf_instrumentation::probe( "transfer"_n.value );
 
-    blacklists blacklistt(_self, _self.value);
-    auto fromexisting = blacklistt.find( from.value );
-    eosio_assert( fromexisting == blacklistt.end(), "account blacklisted(from)" );
-    auto toexisting = blacklistt.find( to.value );
-    eosio_assert( toexisting == blacklistt.end(), "account blacklisted(to)" );
+    const auto cfg = get_config();
+    check( !cfg.paused, "contract is paused." );
 
-    eosio_assert( from != to, "cannot transfer to self" );
+    check_blacklist( cfg, from, "account blacklisted(from)" );
+    check_blacklist( cfg, to, "account blacklisted(to)" );
+
+    check( from != to, "cannot transfer to self" );
     require_auth( from );
-    eosio_assert( is_account( to ), "to account does not exist");
+    check( is_account( to ), "to account does not exist");
     auto sym = quantity.symbol.code();
     stats statstable( _self, sym.raw() );
     const auto& st = statstable.get( sym.raw() );
+    _probe.read();
 
     require_recipient( from );
     require_recipient( to );
 
-    eosio_assert( quantity.is_valid(), "invalid quantity" );
-    eosio_assert( quantity.amount > 0, "must transfer positive quantity" );
-    eosio_assert( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
-    eosio_assert( memo.size() <= 256, "memo has more than 256 bytes" );
+    check( quantity.is_valid(), "invalid quantity" );
+    check( quantity.amount > 0, "must transfer positive quantity" );
+    check( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
+    check( memo.size() <= 256, "memo has more than 256 bytes" );
 
     auto payer = has_auth( to ) ? to : from;
 
     sub_balance( from, quantity );
     add_balance( to, quantity, payer );
+
+    _probe.emit( _self, "log"_n );
+}
+
+/**
+ * Action: transfer tokens from one sender to many recipients.
+ * - Same rules as transfer, applied to every (recipient, quantity) pair.
+ * - Pause, sender blacklist, stats and memo are checked once per batch.
+ * - All quantities must share one symbol; the sender is debited once with the total.
+ */
+ACTION stablecoin::transferbatch( name from, std::vector<std::pair<name, asset>> transfers, string memo ) {
+    const auto cfg = get_config();
+    check( !cfg.paused, "contract is paused." );
+    require_auth( from );
+    check( !transfers.empty(), "no transfers in batch" );
+    check( memo.size() <= 256, "memo has more than 256 bytes" );
+
+    check_blacklist( cfg, from, "account blacklisted(from)" );
+
+    auto sym = transfers.front().second.symbol;
+    stats statstable( _self, sym.code().raw() );
+    const auto& st = statstable.get( sym.code().raw() );
+    check( sym == st.supply.symbol, "symbol precision mismatch" );
+
+    require_recipient( from );
+
+    asset total( 0, sym );
+    for( const auto& t : transfers ) {
+       const name& to = t.first;
+       const asset& quantity = t.second;
+
+       check( from != to, "cannot transfer to self" );
+       check_blacklist( cfg, to, "account blacklisted(to)" );
+       check( is_account( to ), "to account does not exist");
+
+       check( quantity.is_valid(), "invalid quantity" );
+       check( quantity.amount > 0, "must transfer positive quantity" );
+       check( quantity.symbol == sym, "all transfers in batch must use the same symbol" );
+
+       require_recipient( to );
+
+       auto payer = has_auth( to ) ? to : from;
+       add_balance( to, quantity, payer );
+       total += quantity;
+    }
+
+    // Single debit of the sender's row for the whole batch
+    sub_balance( from, total );
 }
 
 /**
@@ -107,21 +174,21 @@ ACTION stablecoin::transfer( name from, name to, asset quantity, string memo ) {
  */
 ACTION stablecoin::burn(asset quantity, string memo ) {
     auto sym = quantity.symbol;
-    eosio_assert( sym.is_valid(), "invalid symbol name" );
-    eosio_assert( memo.size() <= 256, "memo has more than 256 bytes" );
+    check( sym.is_valid(), "invalid symbol name" );
+    check( memo.size() <= 256, "memo has more than 256 bytes" );
 
     auto sym_name = sym.code();
     stats statstable( _self, sym_name.raw() );
     auto existing = statstable.find( sym_name.raw() );
-    eosio_assert( existing != statstable.end(), "token with symbol does not exist, create token before burn" );
+    check( existing != statstable.end(), "token with symbol does not exist, create token before burn" );
     const auto& st = *existing;
 
     require_auth( st.issuer );
-    eosio_assert( quantity.is_valid(), "invalid quantity" );
-    eosio_assert( quantity.amount > 0, "must burn positive or zero quantity" );
+    check( quantity.is_valid(), "invalid quantity" );
+    check( quantity.amount > 0, "must burn positive or zero quantity" );
 
-    eosio_assert( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
-    eosio_assert( quantity.amount <= st.supply.amount, "quantity exceeds available supply");
+    check( quantity.symbol == st.supply.symbol, "symbol precision mismatch" );
+    check( quantity.amount <= st.supply.amount, "quantity exceeds available supply");
 
     statstable.modify( st, same_payer, [&]( auto& s ) {
        s.supply -= quantity;
@@ -134,39 +201,21 @@ ACTION stablecoin::burn(asset quantity, string memo ) {
 /**
  * Action: Pause the contract.
  * - Only allowed by the contract account.
- * - Adds/modifies an entry in the pausetable with paused = true.
+ * - Sets paused = true in the config singleton and erases the legacy pausetable row.
  */
 ACTION stablecoin::pause() {
     require_auth( _self );
-
-    pausetable pauset(_self, _self.value);
-    auto itr = pauset.find(1);
-    if (itr != pauset.end()) {
-      pauset.modify(itr, _self, [&](auto& p) {
-        p.paused = true;
-      });
-    } else {
-      pauset.emplace(_self, [&](auto& p) {
-        p.id = 1;
-        p.paused = true;
-      });
-    }
+    set_paused( true );
 }
 
 /**
  * Action: Unpause contract (allow transfers).
  * - Only allowed for contract account.
- * - Clears pause table.
+ * - Sets paused = false in the config singleton and erases the legacy pausetable row.
  */
 ACTION stablecoin::unpause() {
     require_auth( _self );
-    pausetable pauset(_self, _self.value);
-    while (pauset.begin() != pauset.end()) {
-      auto itr = pauset.end();
-      itr--;
-      pauset.erase(itr);
-      pausetable pauset(_self, _self.value);
-    }
+    set_paused( false );
 }
 
 /**
@@ -176,47 +225,335 @@ ACTION stablecoin::unpause() {
  */
 ACTION stablecoin::blacklist( name account, string memo ) {
     require_auth( _self );
-    eosio_assert( memo.size() <= 256, "memo has more than 256 bytes" );
+    check( memo.size() <= 256, "memo has more than 256 bytes" );
     
     blacklists blacklistt(_self, _self.value);
     auto existing = blacklistt.find( account.value );
-    eosio_assert( existing == blacklistt.end(), "blacklist account already exists" );
+    check( existing == blacklistt.end(), "blacklist account already exists" );
 
     blacklistt.emplace( _self, [&]( auto& b ) {
        b.account = account;
     });
+
+    // Bits are set even while a rebuild is in progress: the rebuild never clears them
+    auto cfg = get_config();
+    add_to_filter( cfg, account );
+    set_config( cfg );
 }
 
 /**
  * Action: remove account from blacklist.
  * - Allowed only for contract account.
+ * - The filter bits of the account stay set (other accounts may share them),
+ *   so checks of the account keep doing the table lookup until rebuildbl restarts the filter.
  */
 ACTION stablecoin::unblacklist( name account) {
     require_auth( _self );
 
     blacklists blacklistt(_self, _self.value);
     auto existing = blacklistt.find( account.value );
-    eosio_assert( existing != blacklistt.end(), "blacklist account not exists" );
+    check( existing != blacklistt.end(), "blacklist account not exists" );
 
     blacklistt.erase(existing);
 }
 
+/**
+ * Action: rebuild the blacklist filter.
+ * - Allowed only for contract account.
+ * - Reads at most max_rows blacklist rows per call, in key order, so a large
+ *   blacklist is indexed across several calls; the filter is used once the last row is added.
+ */
+ACTION stablecoin::rebuildbl( bool restart, uint64_t max_rows ) {
+    require_auth( _self );
+    check( max_rows > 0, "max_rows must be positive" );
+
+    auto cfg = get_config();
+    if( restart ) {
+       cfg.blacklist_filter.fill( 0 );
+       cfg.filter_ready  = false;
+       cfg.filter_cursor = 0;
+    }
+    check( !cfg.filter_ready, "blacklist filter is already built" );
+
+    blacklists blacklistt( _self, _self.value );
+    auto itr = blacklistt.lower_bound( cfg.filter_cursor );
+    for( uint64_t rows = 0; rows < max_rows && itr != blacklistt.end(); ++rows, ++itr ) {
+       add_to_filter( cfg, itr->account );
+       cfg.filter_cursor = itr->account.value + 1;
+    }
+    // The largest account name is the last possible key, the cursor would wrap past it
+    if( itr == blacklistt.end() || cfg.filter_cursor == 0 ) {
+       cfg.filter_ready = true;
+    }
+    set_config( cfg );
+}
+
+/**
+ * Action: select the mint mode used by issue.
+ * - Allowed only for contract account.
+ * - Direct mode replaces the inline transfer, with its checks and balance writes on the
+ *   issuer's row, by the no-op minted action (see the header).
+ */
+ACTION stablecoin::setmintmode( bool direct ) {
+    require_auth( _self );
+
+    auto cfg = get_config();
+    cfg.direct_mint = direct;
+    set_config( cfg );
+}
+
+/**
+ * Read-only action: balances of many accounts.
+ * - The token stats are read once for the symbol precision, then one lookup per owner.
+ */
+std::vector<stablecoin::owner_balance> stablecoin::getbalances( std::vector<name> owners, symbol_code sym ) {
+    stats statstable( _self, sym.raw() );
+    const auto& st = statstable.get( sym.raw(), "token with symbol does not exist" );
+
+    std::vector<owner_balance> balances;
+    balances.reserve( owners.size() );
+    for( const auto& owner : owners ) {
+       accounts acnts( _self, owner.value );
+       auto it = acnts.find( sym.raw() );
+       balances.push_back( { owner, it != acnts.end() ? it->balance : asset{0, st.supply.symbol} } );
+    }
+    return balances;
+}
+
+/**
+ * Read-only action: supplies of many tokens.
+ */
+std::vector<stablecoin::token_supply> stablecoin::getsupplies( std::vector<symbol_code> syms ) {
+    std::vector<token_supply> supplies;
+    supplies.reserve( syms.size() );
+    for( const auto& sym : syms ) {
+       stats statstable( _self, sym.raw() );
+       auto it = statstable.find( sym.raw() );
+       if( it == statstable.end() ) {
+          supplies.push_back( { sym, std::nullopt, std::nullopt } );
+       } else {
+          supplies.push_back( { sym, it->supply, it->max_supply } );
+       }
+    }
+    return supplies;
+}
+
+/**
+ * Action: direct mint notification.
+ * - Only accepted from the contract itself (sent inline by issue).
+ * - Notifies the recipient, as the transfer of a two-step mint would; nothing else is read or written.
+ */
+ACTION stablecoin::minted( name from, name to, asset quantity, string memo ) {
+    check( get_sender() == _self, "minted is only sent by the contract" );
+    require_recipient( to );
+}
+
+#ifdef GF_INSTRUMENTATION
+/**
+ * Action: instrumentation sink.
+ * - Does nothing; the counters are read from the action trace by indexers.
+ */
+ACTION stablecoin::log( gf_instrumentation::counters event ) {
+}
+
+#endif
+/**
+ * Action: open a balance row.
+ * - ram_payer pays for the (zero) balance row and the marker that keeps it.
+ * - Does nothing for rows that are already open.
+ */
+ACTION stablecoin::open( name owner, const symbol& symbol, name ram_payer ) {
+    require_auth( ram_payer );
+    check( is_account( owner ), "owner account does not exist" );
+
+    auto sym_code_raw = symbol.code().raw();
+    stats statstable( _self, sym_code_raw );
+    const auto& st = statstable.get( sym_code_raw, "symbol does not exist" );
+    check( st.supply.symbol == symbol, "symbol precision mismatch" );
+
+    accounts acnts( _self, owner.value );
+    if( acnts.find( sym_code_raw ) == acnts.end() ) {
+       acnts.emplace( ram_payer, [&]( auto& a ){
+         a.balance = asset{0, symbol};
+       });
+    }
+
+    opened openedt( _self, owner.value );
+    if( openedt.find( sym_code_raw ) == openedt.end() ) {
+       openedt.emplace( ram_payer, [&]( auto& o ){
+         o.sym = symbol.code();
+       });
+    }
+}
+
+/**
+ * Action: close a balance row.
+ * - Only the owner can close, and only with a zero balance.
+ * - Later credits fall back to the default: the row is erased whenever it reaches zero.
+ */
+ACTION stablecoin::close( name owner, const symbol& symbol ) {
+    require_auth( owner );
+
+    auto sym_code_raw = symbol.code().raw();
+    accounts acnts( _self, owner.value );
+    auto it = acnts.find( sym_code_raw );
+    check( it != acnts.end(), "Balance row already deleted or never existed. Action won't have any effect." );
+    check( it->balance.amount == 0, "Cannot close because the balance is not zero." );
+    acnts.erase( it );
+
+    opened openedt( _self, owner.value );
+    auto oit = openedt.find( sym_code_raw );
+    if( oit != openedt.end() ) {
+       openedt.erase( oit );
+    }
+}
+
+/**
+ * Action: open a payment stream.
+ * - Only the payer can open it; one stream per (payer, payee) pair.
+ * - Nothing is moved here: the payee settles the accrued amount with claim.
+ */
+ACTION stablecoin::openstream( name payer, name payee, asset rate, asset budget ) {
+    require_auth( payer );
+    check( payer != payee, "cannot stream to self" );
+    check( is_account( payee ), "payee account does not exist");
+
+    const auto cfg = get_config();
+    check_blacklist( cfg, payer, "account blacklisted(from)" );
+    check_blacklist( cfg, payee, "account blacklisted(to)" );
+
+    check( rate.is_valid(), "invalid rate" );
+    check( rate.amount > 0, "rate must be positive" );
+    check( budget.is_valid(), "invalid budget" );
+    check( budget.amount > 0, "budget must be positive" );
+    check( budget.symbol == rate.symbol, "rate and budget symbol mismatch" );
+
+    stats statstable( _self, rate.symbol.code().raw() );
+    const auto& st = statstable.get( rate.symbol.code().raw(), "token with symbol does not exist" );
+    check( rate.symbol == st.supply.symbol, "symbol precision mismatch" );
+
+    streams streamt( _self, payer.value );
+    check( streamt.find( payee.value ) == streamt.end(), "stream to payee already exists" );
+
+    streamt.emplace( payer, [&]( auto& s ) {
+       s.payee      = payee;
+       s.rate       = rate;
+       s.last_claim = current_time_point().sec_since_epoch();
+       s.remaining  = budget;
+    });
+}
+
+/**
+ * Action: claim the amount accrued on a stream.
+ * - Only the payee can claim.
+ * - One debit and one credit however long the stream ran since the last claim.
+ */
+ACTION stablecoin::claim( name payer, name payee ) {
+    require_auth( payee );
+
+    streams streamt( _self, payer.value );
+    const auto& s = streamt.get( payee.value, "stream not found" );
+
+    const asset remaining = settle_stream( payer, s, false );
+    if( remaining.amount == 0 ) {
+       streamt.erase( s );
+    } else {
+       streamt.modify( s, same_payer, [&]( auto& r ) {
+          r.last_claim = current_time_point().sec_since_epoch();
+          r.remaining  = remaining;
+       });
+    }
+}
+
+/**
+ * Action: close a stream.
+ * - Only the payer can close it.
+ * - The payee is paid what accrued up to now, as far as it can be paid,
+ *   then the row (and its RAM) is released in every case.
+ */
+ACTION stablecoin::closestream( name payer, name payee ) {
+    require_auth( payer );
+
+    streams streamt( _self, payer.value );
+    const auto& s = streamt.get( payee.value, "stream not found" );
+
+    settle_stream( payer, s, true );
+    streamt.erase( s );
+}
+
+/**
+ * Internal method: true if owner opened a balance row for sym.
+ */
+bool stablecoin::is_opened( name owner, symbol_code sym ) {
+   opened openedt( _self, owner.value );
+   _probe.read();
+   return openedt.find( sym.raw() ) != openedt.end();
+}
+
+/**
+ * Internal method: settle a stream.
+ * The accrued amount is rate times the seconds since the last claim, capped by the
+ * remaining budget; it is moved with the same checks as transfer.
+ * If the payer's balance cannot cover it, the action fails and nothing is settled.
+ * With best_effort nothing fails instead: a paused contract or a blacklisted party
+ * settles nothing, and a short balance settles what the payer has.
+ */
+asset stablecoin::settle_stream( name payer, const stream& s, bool best_effort ) {
+    const uint32_t elapsed = current_time_point().sec_since_epoch() - s.last_claim;
+
+    // Below this many seconds rate * elapsed stays within the budget (and cannot overflow)
+    const int64_t affordable = s.remaining.amount / s.rate.amount;
+    asset owed = elapsed < affordable ? s.rate * elapsed : s.remaining;
+    if( owed.amount == 0 ) {
+       return s.remaining;
+    }
+
+    const auto cfg = get_config();
+    if( best_effort ) {
+       if( cfg.paused || is_blacklisted( cfg, payer ) || is_blacklisted( cfg, s.payee ) ) {
+          return s.remaining;
+       }
+       accounts acnts( _self, payer.value );
+       auto it = acnts.find( owed.symbol.code().raw() );
+       owed.amount = std::min( owed.amount, it != acnts.end() ? it->balance.amount : 0 );
+       if( owed.amount == 0 ) {
+          return s.remaining;
+       }
+    } else {
+       check( !cfg.paused, "contract is paused." );
+       check_blacklist( cfg, payer, "account blacklisted(from)" );
+       check_blacklist( cfg, s.payee, "account blacklisted(to)" );
+    }
+
+    require_recipient( payer );
+    require_recipient( s.payee );
+
+    sub_balance( payer, owed );
+    add_balance( s.payee, owed, has_auth( s.payee ) ? s.payee : payer );
+    return s.remaining - owed;
+}
+
 /**
  * Internal method: decrease the owner account balance by value.
- * If the balance becomes zero, the record is deleted.
+ * If the balance becomes zero, the record is deleted, unless the owner opened it
+ * with open: then it is kept at zero so the next credit is a modify, not an emplace.
+ * The opened table is only looked up when the balance actually reaches zero.
  */
 void stablecoin::sub_balance( name owner, asset value ) {
    accounts from_acnts( _self, owner.value );
 
    const auto& from = from_acnts.get( value.symbol.code().raw(), "no balance object found" );
-   eosio_assert( from.balance.amount >= value.amount, "overdrawn balance" );
+   _probe.read();
+   check( from.balance.amount >= value.amount, "overdrawn balance" );
 
-   if( from.balance.amount == value.amount ) {
+   if( from.balance.amount == value.amount && !is_opened( owner, value.symbol.code() ) ) {
       from_acnts.erase( from );
+      _probe.write( 1, 0 );
    } else {
       from_acnts.modify( from, owner, [&]( auto& a ) {
           a.balance -= value;
       });
+      _probe.write( from );
    }
 }
 
@@ -228,29 +565,135 @@ void stablecoin::sub_balance( name owner, asset value ) {
 void stablecoin::add_balance( name owner, asset value, name ram_payer ) {
    accounts to_acnts( _self, owner.value );
    auto to = to_acnts.find( value.symbol.code().raw() );
+   _probe.read();
    if( to == to_acnts.end() ) {
-      to_acnts.emplace( ram_payer, [&]( auto& a ){
+      auto it = to_acnts.emplace( ram_payer, [&]( auto& a ){
         a.balance = value;
       });
+      _probe.write( *it );
    } else {
       to_acnts.modify( to, same_payer, [&]( auto& a ) {
         a.balance += value;
       });
+      _probe.write( *to );
    }
 }
 
 /**
- * Internal method: increase owner balance by value.
- * If there was no account, a new record is created, otherwise the amount is increased.
- * ram_payer — who pays for the memory for the new record.
+ * Internal method: read the config singleton.
+ * Returns default values if the config was never stored. A contract upgraded from
+ * the pausetable layout then keeps its pause state: it is paused while the legacy row exists.
+ */
+stablecoin::config_state stablecoin::get_config() {
+   config_singleton configs( _self, _self.value );
+   _probe.read();
+   if( configs.exists() ) {
+      return configs.get();
+   }
+
+   config_state cfg;
+   legacy_pausetable pauset( _self, _self.value );
+   _probe.read();
+   cfg.paused = pauset.find( 1 ) != pauset.end();
+   return cfg;
+}
+
+/**
+ * Internal method: set the pause state.
+ * The legacy pausetable row is erased once the state lives in the config.
+ */
+void stablecoin::set_paused( bool paused ) {
+   auto cfg = get_config();
+   cfg.paused = paused;
+   set_config( cfg );
+
+   legacy_pausetable pauset( _self, _self.value );
+   auto itr = pauset.find( 1 );
+   if( itr != pauset.end() ) {
+      pauset.erase( itr );
+   }
+}
+
+/**
+ * Internal method: write the config singleton.
+ * The contract account pays for the single config row.
+ */
+void stablecoin::set_config( const config_state& cfg ) {
+   config_singleton configs( _self, _self.value );
+   configs.set( cfg, _self );
+   _probe.write( cfg );
+}
+
+/**
+ * Internal method: assert that account is not in the blacklist.
+ * The filter lives in the config, which every caller has already read, so an account
+ * with either filter bit clear is passed without touching the blacklist table.
+ * Only accounts with both bits set (blacklisted ones and the filter's false positives)
+ * cost a primary key lookup. Until rebuildbl has finished, e.g. right after an upgrade
+ * that kept existing blacklist rows, every check does the lookup.
+ */
+void stablecoin::check_blacklist( const config_state& cfg, name account, const char* msg ) {
+   if( filter_rules_out( cfg, account ) ) {
+      return;
+   }
+   blacklists blacklistt( _self, _self.value );
+   _probe.read();
+   check( blacklistt.find( account.value ) == blacklistt.end(), msg );
+}
+
+/**
+ * Internal method: non-asserting form of check_blacklist.
+ */
+bool stablecoin::is_blacklisted( const config_state& cfg, name account ) {
+   if( filter_rules_out( cfg, account ) ) {
+      return false;
+   }
+   blacklists blacklistt( _self, _self.value );
+   _probe.read();
+   return blacklistt.find( account.value ) != blacklistt.end();
+}
+
+/**
+ * Internal method: true if the filter is built and either bit of the account is clear.
+ */
+bool stablecoin::filter_rules_out( const config_state& cfg, name account ) {
+   if( !cfg.filter_ready ) {
+      return false;
+   }
+   const auto bits = filter_bits( account );
+   return !( cfg.blacklist_filter[bits.first / 64] >> ( bits.first % 64 ) & 1 ) ||
+          !( cfg.blacklist_filter[bits.second / 64] >> ( bits.second % 64 ) & 1 );
+}
+
+/**
+ * Internal method: filter bits of an account.
+ * The account name is mixed (splitmix64 finalizer) since names that share a
+ * prefix differ only in their low bits.
+ */
+std::pair<uint32_t, uint32_t> stablecoin::filter_bits( name account ) {
+   uint64_t h = account.value + 0x9e3779b97f4a7c15ULL;
+   h = ( h ^ ( h >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+   h = ( h ^ ( h >> 27 ) ) * 0x94d049bb133111ebULL;
+   h = h ^ ( h >> 31 );
+
+   const uint32_t size = BLACKLIST_FILTER_WORDS * 64;
+   return { uint32_t( h % size ), uint32_t( ( h >> 32 ) % size ) };
+}
+
+/**
+ * Internal method: set the filter bits of account.
  */
-bool stablecoin::is_paused() {
-      pausetable pauset(_self, _self.value);
-      bool existing = ( pauset.find( 1 ) == pauset.end() );
-      return existing;
+void stablecoin::add_to_filter( config_state& cfg, name account ) {
+   const auto bits = filter_bits( account );
+   cfg.blacklist_filter[bits.first / 64]  |= 1ULL << ( bits.first % 64 );
+   cfg.blacklist_filter[bits.second / 64] |= 1ULL << ( bits.second % 64 );
 }
 
 /**
  * EOSIO_DISPATCH macro - registers all contract actions for external calling.
  */
-EOSIO_DISPATCH( stablecoin, (create)(issue)(transfer)(burn)(pause)(unpause)(blacklist)(unblacklist) )
+#ifdef GF_INSTRUMENTATION
+EOSIO_DISPATCH( stablecoin, (create)(issue)(transfer)(transferbatch)(burn)(pause)(unpause)(blacklist)(unblacklist)(rebuildbl)(setmintmode)(getbalances)(getsupplies)(open)(close)(openstream)(claim)(closestream)(minted)(log) )
+#else
+EOSIO_DISPATCH( stablecoin, (create)(issue)(transfer)(transferbatch)(burn)(pause)(unpause)(blacklist)(unblacklist)(rebuildbl)(setmintmode)(getbalances)(getsupplies)(open)(close)(openstream)(claim)(closestream)(minted) )
+#endif
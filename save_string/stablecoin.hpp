@@ -1,8 +1,17 @@
 #pragma once
 
-#include <eosiolib/asset.hpp>
-#include <eosiolib/eosio.hpp>
+#include <eosio/asset.hpp>
+#include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
+#include <eosio/system.hpp>
+#include <algorithm>
+#include <array>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "instrumentation.hpp"
 
 using namespace eosio;
 using std::string;
@@ -39,6 +48,16 @@ public:
        */
       ACTION transfer( name from, name to, asset quantity, string memo );
 
+      /**
+       * Batched transfer from one sender to many recipients.
+	   * Pause, sender blacklist and token stats are checked once for the whole batch,
+	   * and the sender's balance is debited once with the total.
+	   * from — sender.
+	   * transfers — list of (recipient, quantity) pairs, all in the same token.
+	   * memo — arbitrary comment, shared by every transfer in the batch.
+       */
+      ACTION transferbatch( name from, std::vector<std::pair<name, asset>> transfers, string memo );
+
       /**
 	   * Token burning by the issuer.
 	   * quantity — the number of tokens to be destroyed.
@@ -71,6 +90,111 @@ public:
        */
       ACTION unblacklist( name account );
 
+      /**
+	   * Rebuild the blacklist filter kept in the config from the blacklist table.
+	   * Must be run once after deploying or upgrading the contract (until then every
+	   * transfer looks up the blacklist table), and should be run with restart after
+	   * accounts were unblacklisted, to clear the bits they left behind (see config_state).
+	   * restart — true: clear the filter and start over from the first row;
+	   *           false: continue from where the previous call stopped.
+	   * max_rows — maximum number of blacklist rows to read in this call.
+	   * Only contract account can call.
+       */
+      ACTION rebuildbl( bool restart, uint64_t max_rows );
+
+      /**
+	   * Select how issue delivers tokens to a recipient other than the issuer.
+	   * direct — true: credit the recipient in the issue action itself (notifying the recipient);
+	   *          false: credit the issuer, then send an inline transfer (default).
+	   * In direct mode no transfer action is sent for a mint; the contract sends a minted
+	   * action with the same fields instead, so trackers that follow transfer-shaped actions
+	   * only need to follow minted too.
+	   * Only contract account can call.
+       */
+      ACTION setmintmode( bool direct );
+
+      /**
+	   * Open a balance row for owner and keep it when the balance reaches zero.
+	   * Without it, a row is erased at zero and re-created on the next credit.
+	   * ram_payer — who pays for the memory of the rows (must authorize).
+       */
+      ACTION open( name owner, const symbol& symbol, name ram_payer );
+
+      /**
+	   * Close a zero balance row opened with open (releases its memory).
+	   * Only the owner can call.
+       */
+      ACTION close( name owner, const symbol& symbol );
+
+      /**
+	   * Open a payment stream from payer to payee.
+	   * The payee accrues rate for every second since the last claim, up to budget in total.
+	   * Tokens stay in the payer's balance until claimed (no escrow).
+	   * rate — amount accrued per second.
+	   * budget — total amount the stream may pay out.
+	   * Only the payer can call.
+       */
+      ACTION openstream( name payer, name payee, asset rate, asset budget );
+
+      /**
+	   * Settle the amount accrued on a stream from payer to the payee.
+	   * The stream is erased once its budget is paid out.
+	   * Only the payee can call.
+       */
+      ACTION claim( name payer, name payee );
+
+      /**
+	   * Close a stream, settling what has accrued so far to the payee first.
+	   * Settlement is best effort so the stream can always be closed: nothing is paid while
+	   * the contract is paused or either party is blacklisted, and at most the payer's balance.
+	   * Only the payer can call.
+       */
+      ACTION closestream( name payer, name payee );
+
+      /**
+	   * Balance of one account, as returned by getbalances.
+       */
+      struct owner_balance {
+            name        owner;   // Account
+            asset       balance; // Balance in the token (zero if the account has no row)
+      };
+
+      /**
+	   * Supply of one token, as returned by getsupplies.
+       */
+      struct token_supply {
+            symbol_code          sym;        // Token symbol code
+            std::optional<asset> supply;     // Current supply (empty for unknown symbols)
+            std::optional<asset> max_supply; // Maximum permitted emission (empty for unknown symbols)
+      };
+
+      /**
+	   * Read-only: the balances of many accounts in one token, in the order of owners.
+	   * Accounts without a row are listed with a zero balance.
+       */
+      [[eosio::action, eosio::read_only]]
+      std::vector<owner_balance> getbalances( std::vector<name> owners, symbol_code sym );
+
+      /**
+	   * Read-only: the supplies of many tokens, in the order of syms.
+       */
+      [[eosio::action, eosio::read_only]]
+      std::vector<token_supply> getsupplies( std::vector<symbol_code> syms );
+
+      /**
+	   * No-op notification of a direct mint, shaped like transfer (from is the issuer).
+	   * Sent inline by issue in direct mode and delivered to the recipient;
+	   * fails unless sent by the contract itself.
+       */
+      ACTION minted( name from, name to, asset quantity, string memo );
+
+#ifdef GF_INSTRUMENTATION
+      /**
+	   * No-op action carrying the cost counters of a hot path, sent inline by the contract.
+       */
+      ACTION log( gf_instrumentation::counters event );
+
+#endif
       /**
        * Get the current supply (emission) of the token.
        */
@@ -89,6 +213,9 @@ public:
             return ac.balance;
       }
 
+      using transfer_action = eosio::action_wrapper<"transfer"_n, &stablecoin::transfer>;
+      using minted_action = eosio::action_wrapper<"minted"_n, &stablecoin::minted>;
+
 private:
       /**
 	   * Account balance table.
@@ -120,19 +247,74 @@ private:
       };
 
       /**
-       * Table for storing the contract pause status.
+	   * Balances opened with open (scope = owner).
+	   * The balance row of a listed symbol is kept at zero instead of being erased.
+       */
+      TABLE opened_balance {
+            symbol_code sym; // Token symbol code
+            uint64_t primary_key()const { return sym.raw(); }
+      };
+
+      /**
+	   * Payment streams table (scope = payer).
+	   * One stream per payee; accrued amounts are settled lazily by claim.
+       */
+      TABLE stream {
+            name        payee;        // Receiver of the stream
+            asset       rate;         // Amount accrued per second
+            uint32_t    last_claim;   // Time (seconds) the stream was last settled
+            asset       remaining;    // Budget not yet paid out
+            uint64_t primary_key()const { return payee.value; }
+      };
+
+      /**
+	   * Pause state of contracts deployed before the config singleton (scope = contract).
+	   * The contract was paused while row 1 existed. Only read by get_config as the fallback
+	   * while no config is stored, and erased by the first pause/unpause; not part of the ABI.
        */
-      TABLE pause_table {
+      struct legacy_pause {
             uint64_t            id;     // Always 1, single line
             bool                paused; // True if the contract is paused
             auto primary_key() const {  return id;  }
       };
 
+      // Size of the blacklist filter, in 64-bit words (1024 bits)
+      static constexpr uint32_t BLACKLIST_FILTER_WORDS = 16;
+
+      /**
+       * Contract-wide configuration flags (pause state, etc).
+	   * Stored as a singleton and read once per action.
+	   * blacklist_filter is a bloom filter of the blacklisted accounts (two bits per account):
+	   * an account with a clear bit is not blacklisted, so its check needs no table lookup.
+	   * The filter only pays off for small blacklists. With n blacklisted accounts about
+	   * (1 - e^(-n/512))^2 of the other accounts are false positives: 15% at 256, 39% at 500,
+	   * 74% at 1,000 and nearly all beyond a few thousand, where every check does the table
+	   * lookup again and the filter is 128 bytes of config read for nothing.
+	   * unblacklist leaves bits set, so the rate only grows until rebuildbl restarts the filter.
+       */
+      TABLE config_state {
+            bool                paused = false; // True if the contract is paused
+            bool                direct_mint = false; // True if issue credits the recipient directly
+            std::array<uint64_t, BLACKLIST_FILTER_WORDS> blacklist_filter = {}; // Bloom filter of blacklisted accounts
+            bool                filter_ready = false; // True once rebuildbl has added every blacklist row to the filter
+            uint64_t            filter_cursor = 0; // Next account to add while rebuildbl is in progress
+      };
+
       // Definitions of multi_index tables for access within a contract
       typedef eosio::multi_index< "accounts"_n, account > accounts;
       typedef eosio::multi_index< "stat"_n, currency_stats > stats;
       typedef eosio::multi_index< "blacklists"_n, blacklist_table > blacklists;
-      typedef eosio::multi_index< "pausetable"_n, pause_table > pausetable;
+      typedef eosio::multi_index< "streams"_n, stream > streams;
+      typedef eosio::multi_index< "opened"_n, opened_balance > opened;
+      typedef eosio::singleton< "config"_n, config_state > config_singleton;
+      typedef eosio::multi_index< "pausetable"_n, legacy_pause > legacy_pausetable;
+
+      /**
+	   * Cost counters of the running action.
+	   * The helpers below count their table operations here; an instrumented action
+	   * resets it on entry and emits it at the end, other actions never emit it.
+       */
+      gf_instrumentation::probe _probe{ 0 };
 
       /**
        * Internal method: decrease account balance (called on transfers/burning).
@@ -145,7 +327,55 @@ private:
       void add_balance( name owner, asset value, name ram_payer );
 
       /**
-       * Internal method: Check if the contract is in paused state.
+       * Internal method: read the contract configuration (defaults if never set).
+       */
+      config_state get_config();
+
+      /**
+       * Internal method: store the pause state, erasing the legacy pausetable row.
+       */
+      void set_paused( bool paused );
+
+      /**
+       * Internal method: store the contract configuration.
+       */
+      void set_config( const config_state& cfg );
+
+      /**
+       * Internal method: assert that the account is not blacklisted.
+       * Skips the table lookup when the filter rules the account out.
+       */
+      void check_blacklist( const config_state& cfg, name account, const char* msg );
+
+      /**
+       * Internal method: true if the account is blacklisted (same lookups as check_blacklist).
+       */
+      bool is_blacklisted( const config_state& cfg, name account );
+
+      /**
+       * Internal method: true if the filter proves the account is not blacklisted.
+       */
+      static bool filter_rules_out( const config_state& cfg, name account );
+
+      /**
+       * Internal method: the two filter bits of account, as bit indexes.
+       */
+      static std::pair<uint32_t, uint32_t> filter_bits( name account );
+
+      /**
+       * Internal method: set the filter bits of account.
+       */
+      static void add_to_filter( config_state& cfg, name account );
+
+      /**
+       * Internal method: true if owner keeps a zero balance row of sym (see open).
+       */
+      bool is_opened( name owner, symbol_code sym );
+
+      /**
+       * Internal method: pay the amount accrued on a stream since its last claim.
+       * best_effort — pay what can be paid instead of failing (see closestream).
+       * Returns the remaining budget; the stream row is updated by the caller.
        */
-      bool is_paused();
+      asset settle_stream( name payer, const stream& s, bool best_effort );
 };